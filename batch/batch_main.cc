@@ -0,0 +1,82 @@
+// Batch processing of recorded scans.
+//
+// Filter, convert to CSV and extract line segments of every recording in
+// a directory, using all cores:
+// blaze run -c opt //batch:batch_main -- --input=/data/recordings
+// --output_dir=/tmp/out --stages=filter,convert,map,stats
+//
+// Globs work too:
+// blaze run -c opt //batch:batch_main -- --input='/data/2025-*/*.txtpb'
+
+#include <filesystem>
+#include <system_error>
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "batch/batch_processor.h"
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "status_macros.h"
+
+ABSL_FLAG(std::string, input, "",
+          "Directory with *.txtpb recordings or a glob pattern.");
+ABSL_FLAG(std::string, output_dir, "",
+          "Directory for outputs and summary.txt. Nothing is written if "
+          "empty.");
+ABSL_FLAG(std::string, stages, "filter,stats",
+          "Comma separated chain of filter, convert, map and stats.");
+ABSL_FLAG(int32_t, threads, 0, "Worker threads, 0 for all cores.");
+ABSL_FLAG(int32_t, min_quality, 0, "Filter drops samples below quality.");
+ABSL_FLAG(int64_t, chunk_bytes, int64_t{1} << 19,
+          "Recordings are parsed in parallel in chunks of about this size.");
+
+absl::Status Run() {
+  ASSIGN_OR_RETURN(auto files,
+                   slam_dunk::ExpandInputs(absl::GetFlag(FLAGS_input)));
+  slam_dunk::BatchProcessor::Options options;
+  ASSIGN_OR_RETURN(options.stages,
+                   slam_dunk::ParseStages(absl::GetFlag(FLAGS_stages)));
+  options.output_dir = absl::GetFlag(FLAGS_output_dir);
+  options.min_quality = static_cast<uint8_t>(absl::GetFlag(FLAGS_min_quality));
+  options.chunk_bytes = absl::GetFlag(FLAGS_chunk_bytes);
+  if (absl::GetFlag(FLAGS_threads) > 0) {
+    options.num_threads = absl::GetFlag(FLAGS_threads);
+  }
+  if (!options.output_dir.empty()) {
+    std::error_code error;
+    std::filesystem::create_directories(options.output_dir, error);
+    if (error) {
+      return absl::InternalError(absl::StrCat(
+          "Cannot create ", options.output_dir, ": ", error.message()));
+    }
+  }
+
+  LOG(INFO) << "Processing " << files.size() << " recordings";
+  const auto summary = slam_dunk::BatchProcessor(options).Run(files);
+  LOG(INFO) << summary.ToString();
+  if (!options.output_dir.empty()) {
+    RETURN_IF_ERROR(slam_dunk::WriteSummary(
+        summary,
+        (std::filesystem::path(options.output_dir) / "summary.txt").string()));
+  }
+  for (const auto& file : summary.files) {
+    if (!file.status.ok()) {
+      return absl::DataLossError("Some recordings failed, see summary");
+    }
+  }
+  return absl::OkStatus();
+}
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(*argv);
+  absl::ParseCommandLine(argc, argv);
+  gflags::SetCommandLineOption("logtostderr", "1");
+
+  if (auto status = Run(); !status.ok()) {
+    LOG(ERROR) << status.message();
+    return EXIT_FAILURE;
+  }
+  LOG(INFO) << "Done.";
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,395 @@
+#include "batch/batch_processor.h"
+#include <glob.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <utility>
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+#include "batch/scan_text_parser.h"
+#include "batch/work_stealing_pool.h"
+#include "lidar.h"
+#include "line_features/line_extractor.h"
+#include "proto_utils.h"
+#include "scan_geometry.h"
+
+namespace slam_dunk {
+namespace {
+
+bool IsChunkLocal(BatchStage stage) {
+  return stage == BatchStage::kFilter || stage == BatchStage::kStats;
+}
+
+void Filter(std::vector<ScanResponse>& scan, uint8_t min_quality) {
+  std::erase_if(scan, [min_quality](const ScanResponse& response) {
+    return !IsValid(response) || response.quality < min_quality;
+  });
+}
+
+void CollectStats(const std::vector<ScanResponse>& scan, FileStats& stats) {
+  stats.kept += static_cast<int64_t>(scan.size());
+  for (const auto& response : scan) {
+    if (!IsValid(response)) continue;
+    ++stats.valid;
+    stats.min_distance_mm =
+        std::min(stats.min_distance_mm, response.distance_mm);
+    stats.max_distance_mm =
+        std::max(stats.max_distance_mm, response.distance_mm);
+    stats.sum_distance_mm += response.distance_mm;
+  }
+}
+
+absl::Status CreateParent(const std::string& path) {
+  std::error_code error;
+  std::filesystem::create_directories(std::filesystem::path(path).parent_path(),
+                                      error);
+  if (error) {
+    return absl::InternalError(absl::StrCat("Failed to create directory for ",
+                                            path, ": ", error.message()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status Convert(const std::vector<ScanResponse>& scan,
+                     absl::string_view file_path) {
+  std::ofstream output(std::string{file_path});
+  if (!output) {
+    return absl::InternalError(absl::StrCat("Failed to write to ", file_path));
+  }
+  output << "theta_deg,range_m,x_m,y_m,quality\n";
+  for (const auto& response : scan) {
+    const Eigen::Vector2d p = ToCartesian(response);
+    output << absl::StrFormat("%.4f,%.4f,%.4f,%.4f,%d\n",
+                              ThetaToRadians(response.theta) * 180.0 / M_PI,
+                              DistanceToMeters(response.distance_mm), p.x(),
+                              p.y(), response.quality);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status Map(const std::vector<ScanResponse>& scan,
+                 absl::string_view file_path, FileStats& stats) {
+  LineExtractor extractor;
+  const std::vector<LineSegment> segments = extractor.Extract(scan);
+  stats.segments = static_cast<int32_t>(segments.size());
+  if (file_path.empty()) return absl::OkStatus();
+  std::ofstream output(std::string{file_path});
+  if (!output) {
+    return absl::InternalError(absl::StrCat("Failed to write to ", file_path));
+  }
+  output << "rho_m,alpha_rad,start_x_m,start_y_m,end_x_m,end_y_m,points\n";
+  for (const auto& s : segments) {
+    output << absl::StrFormat("%.4f,%.5f,%.4f,%.4f,%.4f,%.4f,%d\n", s.rho,
+                              s.alpha, s.start.x(), s.start.y(), s.end.x(),
+                              s.end.y(), s.num_points);
+  }
+  return absl::OkStatus();
+}
+
+// State of one recording shared by its chunk tasks.
+struct FileJob {
+  std::string path;
+  // Outputs are this plus a suffix.
+  std::string output_stem;
+  FileResult* result;
+  absl::Time start;
+  std::string text;
+  std::vector<absl::string_view> pieces;
+  std::vector<std::vector<ScanResponse>> chunks;
+  std::vector<FileStats> chunk_stats;
+  std::vector<absl::Status> statuses;
+  std::atomic<int32_t> remaining = 0;
+};
+
+}  // namespace
+
+void FileStats::Merge(const FileStats& that) {
+  bytes += that.bytes;
+  items += that.items;
+  kept += that.kept;
+  valid += that.valid;
+  min_distance_mm = std::min(min_distance_mm, that.min_distance_mm);
+  max_distance_mm = std::max(max_distance_mm, that.max_distance_mm);
+  sum_distance_mm += that.sum_distance_mm;
+  segments += that.segments;
+}
+
+absl::StatusOr<std::vector<BatchStage>> ParseStages(absl::string_view stages) {
+  std::vector<BatchStage> result;
+  for (absl::string_view name :
+       absl::StrSplit(stages, ',', absl::SkipEmpty())) {
+    if (name == "filter") {
+      result.push_back(BatchStage::kFilter);
+    } else if (name == "convert") {
+      result.push_back(BatchStage::kConvert);
+    } else if (name == "map") {
+      result.push_back(BatchStage::kMap);
+    } else if (name == "stats") {
+      result.push_back(BatchStage::kStats);
+    } else {
+      return absl::InvalidArgumentError(absl::StrCat("Unknown stage: ", name));
+    }
+  }
+  return result;
+}
+
+std::vector<absl::StatusOr<std::string>> OutputStems(
+    const std::vector<std::string>& inputs, absl::string_view output_dir) {
+  std::vector<absl::StatusOr<std::string>> stems(inputs.size());
+  // Empty for inputs whose absolute path is unknown.
+  std::vector<std::filesystem::path> paths(inputs.size());
+  std::optional<std::filesystem::path> root;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    std::error_code error;
+    const std::filesystem::path path =
+        std::filesystem::absolute(inputs[i], error);
+    if (error) {
+      stems[i] = absl::InternalError(absl::StrCat(
+          "Failed to resolve ", inputs[i], ": ", error.message()));
+      continue;
+    }
+    paths[i] = path.lexically_normal();
+    const std::filesystem::path parent = paths[i].parent_path();
+    if (!root) {
+      root = parent;
+      continue;
+    }
+    // Ends at "/" at the latest, which prefixes every absolute path.
+    while (std::mismatch(root->begin(), root->end(), parent.begin(),
+                         parent.end())
+               .first != root->end()) {
+      root = root->parent_path();
+    }
+  }
+
+  absl::flat_hash_set<std::string> seen;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (paths[i].empty()) continue;
+    const std::filesystem::path relative = paths[i].lexically_relative(*root);
+    std::string stem = (std::filesystem::path(std::string{output_dir}) /
+                        relative.parent_path() / relative.stem())
+                           .string();
+    if (seen.insert(stem).second) {
+      stems[i] = std::move(stem);
+    } else {
+      stems[i] = absl::AlreadyExistsError(absl::StrCat(
+          inputs[i], " has the same output as another input: ", stem));
+    }
+  }
+  return stems;
+}
+
+absl::StatusOr<std::vector<std::string>> ExpandInputs(absl::string_view input) {
+  std::vector<std::string> files;
+  std::error_code error;
+  if (std::filesystem::is_directory(std::string{input}, error)) {
+    for (const auto& entry :
+         std::filesystem::directory_iterator(std::string{input}, error)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".txtpb") {
+        files.push_back(entry.path().string());
+      }
+    }
+    if (error) {
+      return absl::InternalError(
+          absl::StrCat("Failed to list ", input, ": ", error.message()));
+    }
+  } else {
+    glob_t matches;
+    const int32_t result =
+        glob(std::string{input}.c_str(), 0, nullptr, &matches);
+    if (result == 0) {
+      for (size_t i = 0; i < matches.gl_pathc; ++i) {
+        files.push_back(matches.gl_pathv[i]);
+      }
+    }
+    globfree(&matches);
+    if (result != 0 && result != GLOB_NOMATCH) {
+      return absl::InternalError(absl::StrCat("Failed to glob ", input));
+    }
+  }
+  if (files.empty()) {
+    return absl::NotFoundError(absl::StrCat("No recordings in ", input));
+  }
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+BatchSummary BatchProcessor::Run(const std::vector<std::string>& files) const {
+  BatchSummary summary;
+  summary.files.resize(files.size());
+  const absl::Time start = absl::Now();
+
+  // Stages until the first one that needs the whole scan run on chunks.
+  const auto split = std::find_if_not(options_.stages.begin(),
+                                      options_.stages.end(), IsChunkLocal);
+  const std::vector<BatchStage> chunk_stages(options_.stages.begin(), split);
+  const std::vector<BatchStage> file_stages(split, options_.stages.end());
+
+  const bool write = !options_.output_dir.empty();
+  // Runs the rest of the chain once all chunks are done.
+  auto finish = [this, file_stages, write](FileJob& job) {
+    FileResult& result = *job.result;
+    for (size_t i = 0; i < job.chunks.size(); ++i) {
+      result.status.Update(job.statuses[i]);
+      result.stats.Merge(job.chunk_stats[i]);
+    }
+    job.text.clear();
+    if (!result.status.ok() || file_stages.empty()) {
+      job.chunks.clear();
+      result.elapsed = absl::Now() - job.start;
+      return;
+    }
+    std::vector<ScanResponse> scan;
+    scan.reserve(result.stats.items);
+    for (const auto& chunk : job.chunks) {
+      scan.insert(scan.end(), chunk.begin(), chunk.end());
+    }
+    job.chunks.clear();
+    for (BatchStage stage : file_stages) {
+      switch (stage) {
+        case BatchStage::kFilter:
+          Filter(scan, options_.min_quality);
+          break;
+        case BatchStage::kStats:
+          CollectStats(scan, result.stats);
+          break;
+        case BatchStage::kConvert:
+          if (write) {
+            result.status.Update(
+                Convert(scan, absl::StrCat(job.output_stem, ".csv")));
+          }
+          break;
+        case BatchStage::kMap:
+          result.status.Update(Map(
+              scan,
+              write ? absl::StrCat(job.output_stem, ".segments.csv") : "",
+              result.stats));
+          break;
+      }
+    }
+    result.elapsed = absl::Now() - job.start;
+  };
+
+  const auto stems = write ? OutputStems(files, options_.output_dir)
+                           : std::vector<absl::StatusOr<std::string>>();
+  WorkStealingPool pool(options_.num_threads);
+  for (size_t i = 0; i < files.size(); ++i) {
+    pool.Schedule([&, i] {
+      auto job = std::make_shared<FileJob>();
+      job->path = files[i];
+      job->result = &summary.files[i];
+      job->start = absl::Now();
+      job->result->path = files[i];
+      if (write) {
+        absl::Status status = stems[i].status();
+        if (status.ok()) {
+          job->output_stem = *stems[i];
+          status = CreateParent(job->output_stem);
+        }
+        if (!status.ok()) {
+          job->result->status = status;
+          job->result->elapsed = absl::Now() - job->start;
+          return;
+        }
+      }
+      auto text = GetTextFromFile(files[i]);
+      if (!text.ok()) {
+        job->result->status = text.status();
+        job->result->elapsed = absl::Now() - job->start;
+        return;
+      }
+      job->text = *std::move(text);
+      job->result->stats.bytes = static_cast<int64_t>(job->text.size());
+
+      // Chunks are parsed in parallel too, parsing dominates the chain.
+      job->pieces = SplitScanText(
+          job->text,
+          static_cast<size_t>(std::max<int64_t>(options_.chunk_bytes, 1)));
+      if (job->pieces.empty()) job->pieces.emplace_back();
+      job->chunks.resize(job->pieces.size());
+      job->chunk_stats.resize(job->pieces.size());
+      job->statuses.resize(job->pieces.size());
+      job->remaining = static_cast<int32_t>(job->pieces.size());
+
+      for (size_t c = 0; c < job->pieces.size(); ++c) {
+        auto run_chunk = [&, job, c] {
+          std::vector<ScanResponse>& chunk = job->chunks[c];
+          bool used_fallback = false;
+          job->statuses[c] =
+              ParseScanText(job->pieces[c], chunk, used_fallback);
+          job->chunk_stats[c].items = static_cast<int64_t>(chunk.size());
+          for (BatchStage stage : chunk_stages) {
+            if (stage == BatchStage::kFilter) {
+              Filter(chunk, options_.min_quality);
+            } else {
+              CollectStats(chunk, job->chunk_stats[c]);
+            }
+          }
+          // The last chunk to finish carries on with the whole file.
+          if (--job->remaining == 0) finish(*job);
+        };
+        // The last chunk runs in this task, the others can be stolen.
+        if (c + 1 < job->pieces.size()) {
+          pool.Schedule(run_chunk);
+        } else {
+          run_chunk();
+        }
+      }
+    });
+  }
+  pool.Wait();
+
+  summary.wall_time = absl::Now() - start;
+  summary.threads = pool.num_threads();
+  summary.steals = pool.steals();
+  return summary;
+}
+
+std::string BatchSummary::ToString() const {
+  std::string text;
+  int64_t bytes = 0;
+  int64_t items = 0;
+  int32_t failed = 0;
+  for (const auto& file : files) {
+    const double seconds = std::max(absl::ToDoubleSeconds(file.elapsed), 1e-9);
+    absl::StrAppendFormat(
+        &text,
+        "%s items: %d kept: %d segments: %d time: %.2f ms "
+        "throughput: %.0f items/s %.2f MB/s%s\n",
+        file.path, file.stats.items, file.stats.kept, file.stats.segments,
+        seconds * 1e3, file.stats.items / seconds,
+        file.stats.bytes / seconds / 1e6,
+        file.status.ok() ? ""
+                         : absl::StrCat(" error: ", file.status.message()));
+    bytes += file.stats.bytes;
+    items += file.stats.items;
+    failed += !file.status.ok();
+  }
+  const double seconds = std::max(absl::ToDoubleSeconds(wall_time), 1e-9);
+  absl::StrAppendFormat(
+      &text,
+      "Files: %d failed: %d threads: %d steals: %d wall time: %.2f s "
+      "throughput: %.1f files/s %.0f items/s %.2f MB/s\n",
+      files.size(), failed, threads, steals, seconds, files.size() / seconds,
+      items / seconds, bytes / seconds / 1e6);
+  return text;
+}
+
+absl::Status WriteSummary(const BatchSummary& summary,
+                          absl::string_view file_path) {
+  std::ofstream output(std::string{file_path});
+  if (!output) {
+    return absl::InternalError(absl::StrCat("Failed to write to ", file_path));
+  }
+  output << summary.ToString();
+  return absl::OkStatus();
+}
+
+}  // namespace slam_dunk
@@ -0,0 +1,113 @@
+// Offline processing of recorded scans in parallel.
+#ifndef SLAM_DUNK_BATCH_BATCH_PROCESSOR_H_
+#define SLAM_DUNK_BATCH_BATCH_PROCESSOR_H_
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace slam_dunk {
+
+// Steps applied to each recording, in the configured order.
+enum class BatchStage {
+  // Drops samples without return or below the minimum quality.
+  kFilter,
+  // Writes samples as CSV with Cartesian coordinates.
+  kConvert,
+  // Extracts line segments and writes them as CSV.
+  kMap,
+  // Collects range statistics.
+  kStats,
+};
+
+// Parses comma separated stage names, e.g. "filter,map,stats".
+absl::StatusOr<std::vector<BatchStage>> ParseStages(absl::string_view stages);
+
+// Returns recordings (*.txtpb) in a directory, or files matching a glob,
+// sorted by name.
+absl::StatusOr<std::vector<std::string>> ExpandInputs(absl::string_view input);
+
+// Maps every input to `output_dir` joined with the input's path relative to
+// the deepest directory all inputs share, without extension; callers append
+// their own suffix. Inputs from different directories keep them apart, e.g.
+// /data/a/lidar.txtpb and /data/b/lidar.txtpb become <output_dir>/a/lidar
+// and <output_dir>/b/lidar. Inputs that would still collide, such as
+// rec.txtpb and rec.pb, get AlreadyExists, all but the first.
+std::vector<absl::StatusOr<std::string>> OutputStems(
+    const std::vector<std::string>& inputs, absl::string_view output_dir);
+
+// Counters of one recording, mergeable across chunks.
+struct FileStats {
+  int64_t bytes = 0;
+  // Samples read.
+  int64_t items = 0;
+  // Samples left after the filter.
+  int64_t kept = 0;
+  // Over samples with a return, in q2 millimeters.
+  int64_t valid = 0;
+  uint32_t min_distance_mm = std::numeric_limits<uint32_t>::max();
+  uint32_t max_distance_mm = 0;
+  uint64_t sum_distance_mm = 0;
+  // Line segments found by the map stage.
+  int32_t segments = 0;
+
+  void Merge(const FileStats& that);
+};
+
+struct FileResult {
+  std::string path;
+  absl::Status status;
+  FileStats stats;
+  absl::Duration elapsed;
+};
+
+struct BatchSummary {
+  std::vector<FileResult> files;
+  absl::Duration wall_time;
+  int32_t threads = 0;
+  int64_t steals = 0;
+
+  // Human readable report with per-file and total throughput.
+  std::string ToString() const;
+};
+
+// Runs the stage chain over many recordings on a work-stealing pool. Each
+// file is a task; its text is split into chunks of about `chunk_bytes`
+// that are parsed with ParseScanText and put through the leading
+// chunk-local stages (filter, stats) in parallel. The rest of the chain runs
+// on the joined scan, which is only built when such stages exist.
+class BatchProcessor {
+ public:
+  struct Options {
+    std::vector<BatchStage> stages = {BatchStage::kFilter, BatchStage::kStats};
+    // Where convert and map write their outputs, laid out as OutputStems.
+    // Nothing is written if empty.
+    std::string output_dir;
+    uint8_t min_quality = 0;
+    int64_t chunk_bytes = int64_t{1} << 19;
+    int32_t num_threads =
+        static_cast<int32_t>(std::max(1u, std::thread::hardware_concurrency()));
+  };
+
+  explicit BatchProcessor(const Options& options) : options_(options) {}
+
+  // Processes files, failures are reported per file.
+  BatchSummary Run(const std::vector<std::string>& files) const;
+
+ private:
+  Options options_;
+};
+
+// Writes summary into `file_path`.
+absl::Status WriteSummary(const BatchSummary& summary,
+                          absl::string_view file_path);
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_BATCH_BATCH_PROCESSOR_H_
@@ -0,0 +1,54 @@
+// Scaling of batch processing with the number of threads.
+// blaze run -c opt //batch:batch_processor_benchmark
+#include <filesystem>
+#include <benchmark/benchmark.h>
+#include "absl/strings/str_cat.h"
+#include "batch/batch_processor.h"
+#include "proto_utils.h"
+#include "simulated_scan.h"
+
+namespace slam_dunk {
+namespace {
+
+constexpr int32_t kFiles = 64;
+
+// Writes recordings once per process.
+const std::vector<std::string>& Recordings() {
+  static const auto* files = [] {
+    const auto dir =
+        std::filesystem::temp_directory_path() / "batch_processor_benchmark";
+    std::filesystem::create_directories(dir);
+    auto* files = new std::vector<std::string>;
+    for (int32_t i = 0; i < kFiles; ++i) {
+      const auto path = (dir / absl::StrCat("rec", i, ".txtpb")).string();
+      const auto scan = SimulateScan(SimulatedWorld::Room(10, 6),
+                                     Pose2d{.x = 2, .y = 3}, 8192, 0.01, i + 1);
+      if (!SaveToFile(scan, path).ok()) std::abort();
+      files->push_back(path);
+    }
+    return files;
+  }();
+  return *files;
+}
+
+void BM_Batch(benchmark::State& state) {
+  BatchProcessor::Options options;
+  options.stages = {BatchStage::kFilter, BatchStage::kStats, BatchStage::kMap};
+  options.num_threads = state.range(0);
+  const auto& files = Recordings();
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    const BatchSummary summary = BatchProcessor(options).Run(files);
+    bytes = 0;
+    for (const auto& file : summary.files) bytes += file.stats.bytes;
+  }
+  state.SetItemsProcessed(state.iterations() * files.size());
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_Batch)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(
+    benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace slam_dunk
+
+BENCHMARK_MAIN();
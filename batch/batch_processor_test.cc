@@ -0,0 +1,131 @@
+#include "batch/batch_processor.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include "absl/status/status_matchers.h"
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock-matchers.h"
+#include "gtest/gtest.h"
+#include "proto_utils.h"
+#include "simulated_scan.h"
+
+namespace slam_dunk {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::SizeIs;
+
+std::filesystem::path TestDir(absl::string_view name) {
+  const char* tmp = std::getenv("TEST_TMPDIR");
+  auto dir = std::filesystem::path(tmp ? tmp : "/tmp") / std::string(name);
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  return dir;
+}
+
+// Writes `count` recordings of a room, with some empty samples.
+void WriteRecordings(const std::filesystem::path& dir, int32_t count) {
+  for (int32_t i = 0; i < count; ++i) {
+    auto scan = SimulateScan(SimulatedWorld::Room(6, 4),
+                             Pose2d{.x = 1.0 + 0.1 * i, .y = 2}, 2048, 0.005,
+                             /*seed=*/i + 1);
+    for (size_t k = 0; k < scan.size(); k += 10) scan[k].distance_mm = 0;
+    ASSERT_THAT(
+        SaveToFile(scan, (dir / absl::StrCat("rec", i, ".txtpb")).string()),
+        IsOk());
+  }
+}
+
+TEST(ParseStages, Works) {
+  EXPECT_THAT(ParseStages("filter,map,stats"),
+              IsOkAndHolds(ElementsAre(BatchStage::kFilter, BatchStage::kMap,
+                                       BatchStage::kStats)));
+  EXPECT_THAT(ParseStages("filter,slam"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(ExpandInputs, DirectoryAndGlob) {
+  const auto dir = TestDir("expand");
+  WriteRecordings(dir, 3);
+  EXPECT_THAT(ExpandInputs(dir.string()), IsOkAndHolds(SizeIs(3)));
+  EXPECT_THAT(ExpandInputs((dir / "rec[01].txtpb").string()),
+              IsOkAndHolds(SizeIs(2)));
+  EXPECT_THAT(ExpandInputs((dir / "none*").string()),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(OutputStems, KeepsSubdirectories) {
+  EXPECT_THAT(OutputStems({"/data/a/lidar.txtpb", "/data/b/lidar.txtpb",
+                           "/data/b/c/lidar.txtpb", "/data/b/lidar.pb"},
+                          "out"),
+              ElementsAre(IsOkAndHolds("out/a/lidar"),
+                          IsOkAndHolds("out/b/lidar"),
+                          IsOkAndHolds("out/b/c/lidar"),
+                          StatusIs(absl::StatusCode::kAlreadyExists)));
+  EXPECT_THAT(OutputStems({"/data/a/rec0.txtpb", "/data/a/rec1.txtpb"}, "out"),
+              ElementsAre(IsOkAndHolds("out/rec0"), IsOkAndHolds("out/rec1")));
+}
+
+TEST(BatchProcessor, ChunkedRunMatchesSingleThread) {
+  const auto dir = TestDir("chunks");
+  WriteRecordings(dir, 6);
+  auto files = ExpandInputs(dir.string());
+  ASSERT_THAT(files, IsOk());
+
+  BatchProcessor::Options options;
+  options.stages = {BatchStage::kFilter, BatchStage::kStats, BatchStage::kMap};
+  options.num_threads = 1;
+  options.chunk_bytes = 1 << 30;
+  const BatchSummary single = BatchProcessor(options).Run(*files);
+  options.num_threads = 4;
+  options.chunk_bytes = 16 << 10;
+  const BatchSummary chunked = BatchProcessor(options).Run(*files);
+
+  ASSERT_THAT(chunked.files, SizeIs(6));
+  for (size_t i = 0; i < chunked.files.size(); ++i) {
+    const FileStats& a = single.files[i].stats;
+    const FileStats& b = chunked.files[i].stats;
+    EXPECT_THAT(chunked.files[i].status, IsOk());
+    EXPECT_EQ(b.items, 2048);
+    EXPECT_EQ(b.kept, a.kept);
+    EXPECT_LT(b.kept, b.items);
+    EXPECT_EQ(b.valid, b.kept);
+    EXPECT_EQ(b.min_distance_mm, a.min_distance_mm);
+    EXPECT_EQ(b.sum_distance_mm, a.sum_distance_mm);
+    EXPECT_EQ(b.segments, 4);
+  }
+  EXPECT_EQ(chunked.threads, 4);
+}
+
+TEST(BatchProcessor, WritesOutputsAndReportsErrors) {
+  const auto dir = TestDir("outputs");
+  WriteRecordings(dir, 2);
+  {
+    std::ofstream broken(dir / "broken.txtpb");
+    broken << "items { theta: ";
+  }
+  const auto out = TestDir("outputs_out");
+  BatchProcessor::Options options;
+  options.stages = {BatchStage::kFilter, BatchStage::kConvert,
+                    BatchStage::kMap};
+  options.output_dir = out.string();
+  auto files = ExpandInputs(dir.string());
+  ASSERT_THAT(files, IsOk());
+  const BatchSummary summary = BatchProcessor(options).Run(*files);
+
+  ASSERT_THAT(summary.files, SizeIs(3));
+  EXPECT_THAT(summary.files[0].status,
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(summary.files[1].status, IsOk());
+  EXPECT_TRUE(std::filesystem::exists(out / "rec0.csv"));
+  EXPECT_TRUE(std::filesystem::exists(out / "rec1.segments.csv"));
+  EXPECT_THAT(summary.ToString(), HasSubstr("Files: 3 failed: 1"));
+  EXPECT_THAT(WriteSummary(summary, (out / "summary.txt").string()), IsOk());
+}
+
+}  // namespace
+}  // namespace slam_dunk
@@ -0,0 +1,187 @@
+#include "batch/capture_converter.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <system_error>
+#include <utility>
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "batch/batch_processor.h"
+#include "batch/scan_text_parser.h"
+#include "batch/work_stealing_pool.h"
+#include "lidar.h"
+#include "proto_utils.h"
+#include "scan_binary.h"
+
+namespace slam_dunk {
+namespace {
+
+bool SameScan(const std::vector<ScanResponse>& a,
+              const std::vector<ScanResponse>& b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                    [](const ScanResponse& x, const ScanResponse& y) {
+                      return x.theta == y.theta &&
+                             x.distance_mm == y.distance_mm &&
+                             x.quality == y.quality && x.flag == y.flag;
+                    });
+}
+
+// State of one capture shared by its chunk tasks.
+struct FileJob {
+  ConversionResult* result;
+  // Output is this plus ".scanbin".
+  std::string output_stem;
+  absl::Time start;
+  std::string text;
+  std::vector<absl::string_view> pieces;
+  std::vector<std::vector<ScanResponse>> chunks;
+  std::vector<absl::Status> statuses;
+  std::atomic<int32_t> fallbacks = 0;
+  std::atomic<int32_t> remaining = 0;
+};
+
+}  // namespace
+
+ConversionSummary CaptureConverter::Run(
+    const std::vector<std::string>& files) const {
+  ConversionSummary summary;
+  summary.files.resize(files.size());
+  const absl::Time start = absl::Now();
+
+  auto finish = [this](FileJob& job) {
+    ConversionResult& result = *job.result;
+    for (const absl::Status& status : job.statuses) {
+      result.status.Update(status);
+    }
+    result.fallback_chunks = job.fallbacks;
+    if (result.status.ok()) {
+      std::vector<ScanResponse> scan;
+      size_t items = 0;
+      for (const auto& chunk : job.chunks) items += chunk.size();
+      scan.reserve(items);
+      for (const auto& chunk : job.chunks) {
+        scan.insert(scan.end(), chunk.begin(), chunk.end());
+      }
+      result.items = static_cast<int64_t>(scan.size());
+      const std::string output = absl::StrCat(job.output_stem, ".scanbin");
+      std::error_code error;
+      std::filesystem::create_directories(
+          std::filesystem::path(output).parent_path(), error);
+      result.status =
+          error ? absl::InternalError(absl::StrCat(
+                      "Failed to create directory for ", output, ": ",
+                      error.message()))
+                : SaveBinaryToFile(scan, output);
+      if (result.status.ok()) {
+        result.output = output;
+        result.output_bytes = static_cast<int64_t>(
+            kScanBinaryHeaderSize + scan.size() * kScanBinaryRecordSize);
+      }
+    }
+    job.chunks.clear();
+    job.text.clear();
+    result.elapsed = absl::Now() - job.start;
+  };
+
+  const auto stems = OutputStems(files, options_.output_dir);
+  WorkStealingPool pool(options_.num_threads);
+  for (size_t i = 0; i < files.size(); ++i) {
+    pool.Schedule([&, i] {
+      auto job = std::make_shared<FileJob>();
+      job->result = &summary.files[i];
+      job->start = absl::Now();
+      job->result->path = files[i];
+      if (!stems[i].ok()) {
+        job->result->status = stems[i].status();
+        job->result->elapsed = absl::Now() - job->start;
+        return;
+      }
+      job->output_stem = *stems[i];
+      auto text = GetTextFromFile(files[i]);
+      if (!text.ok()) {
+        job->result->status = text.status();
+        job->result->elapsed = absl::Now() - job->start;
+        return;
+      }
+      job->text = *std::move(text);
+      job->result->bytes = static_cast<int64_t>(job->text.size());
+
+      job->pieces = SplitScanText(
+          job->text,
+          static_cast<size_t>(std::max<int64_t>(options_.chunk_bytes, 1)));
+      if (job->pieces.empty()) job->pieces.emplace_back();
+      job->chunks.resize(job->pieces.size());
+      job->statuses.resize(job->pieces.size());
+      job->result->chunks = static_cast<int32_t>(job->pieces.size());
+      job->remaining = static_cast<int32_t>(job->pieces.size());
+
+      for (size_t c = 0; c < job->pieces.size(); ++c) {
+        auto run_chunk = [&, job, c] {
+          bool used_fallback = false;
+          absl::Status& status = job->statuses[c];
+          status = ParseScanText(job->pieces[c], job->chunks[c], used_fallback);
+          if (used_fallback) ++job->fallbacks;
+          if (status.ok() && options_.validate) {
+            auto expected =
+                ConvertTextProtoStringToScanResponse(job->pieces[c]);
+            if (!expected.ok()) {
+              status = expected.status();
+            } else if (!SameScan(*expected, job->chunks[c])) {
+              status = absl::DataLossError(absl::StrFormat(
+                  "Chunk %d differs from the protobuf parser", c));
+            }
+          }
+          // The last chunk to finish writes the file.
+          if (--job->remaining == 0) finish(*job);
+        };
+        // The last chunk runs in this task, the others can be stolen.
+        if (c + 1 < job->pieces.size()) {
+          pool.Schedule(run_chunk);
+        } else {
+          run_chunk();
+        }
+      }
+    });
+  }
+  pool.Wait();
+
+  summary.wall_time = absl::Now() - start;
+  summary.threads = pool.num_threads();
+  return summary;
+}
+
+std::string ConversionSummary::ToString() const {
+  std::string text;
+  int64_t bytes = 0;
+  int64_t output_bytes = 0;
+  int64_t items = 0;
+  int32_t failed = 0;
+  for (const auto& file : files) {
+    const double seconds = std::max(absl::ToDoubleSeconds(file.elapsed), 1e-9);
+    absl::StrAppendFormat(
+        &text,
+        "%s items: %d chunks: %d fallback: %d size: %d -> %d bytes "
+        "time: %.2f ms throughput: %.2f MB/s%s\n",
+        file.path, file.items, file.chunks, file.fallback_chunks, file.bytes,
+        file.output_bytes, seconds * 1e3, file.bytes / seconds / 1e6,
+        file.status.ok() ? ""
+                         : absl::StrCat(" error: ", file.status.message()));
+    bytes += file.bytes;
+    output_bytes += file.output_bytes;
+    items += file.items;
+    failed += !file.status.ok();
+  }
+  const double seconds = std::max(absl::ToDoubleSeconds(wall_time), 1e-9);
+  absl::StrAppendFormat(
+      &text,
+      "Files: %d failed: %d threads: %d wall time: %.2f s size: %d -> %d bytes "
+      "throughput: %.0f items/s %.2f MB/s\n",
+      files.size(), failed, threads, seconds, bytes, output_bytes,
+      items / seconds, bytes / seconds / 1e6);
+  return text;
+}
+
+}  // namespace slam_dunk
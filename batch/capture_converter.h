@@ -0,0 +1,64 @@
+// Converts text proto captures to the binary scan format in parallel.
+#ifndef SLAM_DUNK_BATCH_CAPTURE_CONVERTER_H_
+#define SLAM_DUNK_BATCH_CAPTURE_CONVERTER_H_
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+
+namespace slam_dunk {
+
+struct ConversionResult {
+  std::string path;
+  // Binary file written, empty on failure.
+  std::string output;
+  absl::Status status;
+  int64_t bytes = 0;
+  int64_t output_bytes = 0;
+  int64_t items = 0;
+  int32_t chunks = 0;
+  // Chunks the fast parser gave up on and protobuf parsed.
+  int32_t fallback_chunks = 0;
+  absl::Duration elapsed;
+};
+
+struct ConversionSummary {
+  std::vector<ConversionResult> files;
+  absl::Duration wall_time;
+  int32_t threads = 0;
+
+  // Human readable report with per-file and total throughput.
+  std::string ToString() const;
+};
+
+// Reads each capture whole, splits it at `items {` lines into chunks of
+// about `chunk_bytes` and parses the chunks on a work-stealing pool with
+// ParseScanText. The last chunk of a file to finish joins the samples and
+// writes them to its OutputStems path plus ".scanbin", so captures with the
+// same name in different directories do not overwrite each other.
+class CaptureConverter {
+ public:
+  struct Options {
+    std::string output_dir;
+    int64_t chunk_bytes = int64_t{1} << 20;
+    // Also parse every chunk with protobuf and fail files that differ.
+    bool validate = false;
+    int32_t num_threads =
+        static_cast<int32_t>(std::max(1u, std::thread::hardware_concurrency()));
+  };
+
+  explicit CaptureConverter(const Options& options) : options_(options) {}
+
+  // Converts files, failures are reported per file.
+  ConversionSummary Run(const std::vector<std::string>& files) const;
+
+ private:
+  Options options_;
+};
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_BATCH_CAPTURE_CONVERTER_H_
@@ -0,0 +1,94 @@
+// Text proto parsing, protobuf against the hand-rolled parser, and the
+// scaling of the converter with the number of threads.
+// blaze run -c opt //batch:capture_converter_benchmark
+#include <filesystem>
+#include <benchmark/benchmark.h>
+#include "absl/strings/str_cat.h"
+#include "batch/capture_converter.h"
+#include "batch/scan_text_parser.h"
+#include "proto_utils.h"
+#include "simulated_scan.h"
+
+namespace slam_dunk {
+namespace {
+
+constexpr int32_t kFiles = 16;
+
+// Eight revolutions, about 3.8 MB of text.
+std::vector<ScanResponse> Capture(int32_t seed) {
+  std::vector<ScanResponse> capture;
+  for (int32_t i = 0; i < 8; ++i) {
+    const auto scan = SimulateScan(SimulatedWorld::Room(10, 6),
+                                   Pose2d{.x = 2 + 0.1 * i, .y = 3}, 8192,
+                                   0.01, seed * 8 + i);
+    capture.insert(capture.end(), scan.begin(), scan.end());
+  }
+  return capture;
+}
+
+const std::string& CaptureText() {
+  static const auto* text =
+      new std::string(ConvertScanResponseToTextProtoString(Capture(1)).value());
+  return *text;
+}
+
+void BM_Protobuf(benchmark::State& state) {
+  const std::string& text = CaptureText();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ConvertTextProtoStringToScanResponse(text));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_Protobuf)->Unit(benchmark::kMillisecond);
+
+void BM_ParseScanItems(benchmark::State& state) {
+  const std::string& text = CaptureText();
+  std::vector<ScanResponse> scan;
+  for (auto _ : state) {
+    scan.clear();
+    benchmark::DoNotOptimize(ParseScanItems(text, scan));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ParseScanItems)->Unit(benchmark::kMillisecond);
+
+// Writes captures once per process.
+const std::vector<std::string>& Captures() {
+  static const auto* files = [] {
+    const auto dir =
+        std::filesystem::temp_directory_path() / "capture_converter_benchmark";
+    std::filesystem::create_directories(dir);
+    auto* files = new std::vector<std::string>;
+    for (int32_t i = 0; i < kFiles; ++i) {
+      const auto path = (dir / absl::StrCat("capture", i, ".txtpb")).string();
+      if (!SaveToFile(Capture(i), path).ok()) std::abort();
+      files->push_back(path);
+    }
+    return files;
+  }();
+  return *files;
+}
+
+void BM_Convert(benchmark::State& state) {
+  CaptureConverter::Options options;
+  options.output_dir = (std::filesystem::temp_directory_path() /
+                        "capture_converter_benchmark_out")
+                           .string();
+  std::filesystem::create_directories(options.output_dir);
+  options.num_threads = state.range(0);
+  const auto& files = Captures();
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    const ConversionSummary summary = CaptureConverter(options).Run(files);
+    bytes = 0;
+    for (const auto& file : summary.files) bytes += file.bytes;
+  }
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_Convert)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime()->Unit(
+    benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace slam_dunk
+
+BENCHMARK_MAIN();
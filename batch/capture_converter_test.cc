@@ -0,0 +1,129 @@
+#include "batch/capture_converter.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include "absl/status/status_matchers.h"
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock-matchers.h"
+#include "gtest/gtest.h"
+#include "proto_utils.h"
+#include "scan_binary.h"
+#include "simulated_scan.h"
+
+namespace slam_dunk {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+
+std::filesystem::path TestDir(absl::string_view name) {
+  const char* tmp = std::getenv("TEST_TMPDIR");
+  auto dir = std::filesystem::path(tmp ? tmp : "/tmp") / std::string(name);
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  return dir;
+}
+
+std::vector<ScanResponse> Revolution(int32_t seed) {
+  auto scan = SimulateScan(SimulatedWorld::Room(6, 4),
+                           Pose2d{.x = 1.0 + 0.1 * seed, .y = 2}, 2048, 0.005,
+                           seed);
+  for (size_t k = 0; k < scan.size(); k += 10) scan[k].distance_mm = 0;
+  return scan;
+}
+
+TEST(CaptureConverter, ConvertsInParallelChunks) {
+  const auto dir = TestDir("convert");
+  std::vector<std::string> files;
+  for (int32_t i = 0; i < 4; ++i) {
+    files.push_back((dir / absl::StrCat("rec", i, ".txtpb")).string());
+    ASSERT_THAT(SaveToFile(Revolution(i + 1), files.back()), IsOk());
+  }
+
+  CaptureConverter::Options options;
+  options.output_dir = (dir / "out").string();
+  options.chunk_bytes = 8192;
+  options.validate = true;
+  options.num_threads = 4;
+  std::filesystem::create_directories(options.output_dir);
+  const ConversionSummary summary = CaptureConverter(options).Run(files);
+
+  ASSERT_EQ(summary.files.size(), 4);
+  for (int32_t i = 0; i < 4; ++i) {
+    const ConversionResult& result = summary.files[i];
+    ASSERT_THAT(result.status, IsOk()) << result.path;
+    EXPECT_GT(result.chunks, 5);
+    EXPECT_EQ(result.fallback_chunks, 0);
+    EXPECT_EQ(result.items, 2048);
+    EXPECT_LT(result.output_bytes * 4, result.bytes);
+
+    auto converted = LoadBinaryFromFile(result.output);
+    ASSERT_THAT(converted, IsOk());
+    const auto expected = Revolution(i + 1);
+    ASSERT_EQ(converted->size(), expected.size());
+    for (size_t k = 0; k < expected.size(); ++k) {
+      ASSERT_EQ((*converted)[k].theta, expected[k].theta);
+      ASSERT_EQ((*converted)[k].distance_mm, expected[k].distance_mm);
+      ASSERT_EQ((*converted)[k].quality, expected[k].quality);
+      ASSERT_EQ((*converted)[k].flag, expected[k].flag);
+    }
+  }
+  EXPECT_THAT(summary.ToString(), HasSubstr("Files: 4 failed: 0"));
+}
+
+TEST(CaptureConverter, ReportsFallbackAndFailures) {
+  const auto dir = TestDir("convert_failures");
+  const std::string edited = (dir / "edited.txtpb").string();
+  std::ofstream(edited) << "# Edited by hand\nitems { theta: 1 }\n";
+  const std::string broken = (dir / "broken.txtpb").string();
+  std::ofstream(broken) << "items { theta: 1 \n";
+
+  CaptureConverter::Options options;
+  options.output_dir = dir.string();
+  options.num_threads = 2;
+  const ConversionSummary summary =
+      CaptureConverter(options).Run({edited, broken, (dir / "none").string()});
+
+  ASSERT_THAT(summary.files[0].status, IsOk());
+  EXPECT_EQ(summary.files[0].fallback_chunks, 1);
+  EXPECT_EQ(summary.files[0].items, 1);
+  EXPECT_THAT(summary.files[1].status,
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_TRUE(summary.files[1].output.empty());
+  EXPECT_THAT(summary.files[2].status, StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_THAT(summary.ToString(), HasSubstr("Files: 3 failed: 2"));
+}
+
+TEST(CaptureConverter, KeepsCapturesWithTheSameName) {
+  const auto dir = TestDir("convert_same_name");
+  std::vector<std::string> files;
+  for (int32_t i = 0; i < 2; ++i) {
+    const auto subdir = dir / absl::StrCat("robot", i);
+    std::filesystem::create_directories(subdir);
+    files.push_back((subdir / "lidar.txtpb").string());
+    ASSERT_THAT(SaveToFile(Revolution(i + 1), files.back()), IsOk());
+  }
+  files.push_back((dir / "robot0" / "lidar.pb").string());
+
+  CaptureConverter::Options options;
+  options.output_dir = (dir / "out").string();
+  options.num_threads = 2;
+  const ConversionSummary summary = CaptureConverter(options).Run(files);
+
+  for (int32_t i = 0; i < 2; ++i) {
+    const ConversionResult& result = summary.files[i];
+    ASSERT_THAT(result.status, IsOk()) << result.path;
+    EXPECT_EQ(result.output, (dir / "out" / absl::StrCat("robot", i) /
+                              "lidar.scanbin")
+                                 .string());
+    auto converted = LoadBinaryFromFile(result.output);
+    ASSERT_THAT(converted, IsOk());
+    EXPECT_EQ((*converted)[1].distance_mm, Revolution(i + 1)[1].distance_mm);
+  }
+  EXPECT_THAT(summary.files[2].status,
+              StatusIs(absl::StatusCode::kAlreadyExists));
+}
+
+}  // namespace
+}  // namespace slam_dunk
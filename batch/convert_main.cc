@@ -0,0 +1,79 @@
+// Converts text proto captures to the compact binary scan format.
+//
+// Every capture in a directory, using all cores:
+// blaze run -c opt //batch:convert_main -- --input=/data/recordings
+// --output_dir=/data/binary
+//
+// Double check the fast parser against protobuf while converting:
+// blaze run -c opt //batch:convert_main -- --input='/data/2025-*/*.txtpb'
+// --output_dir=/data/binary --validate
+
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "batch/batch_processor.h"
+#include "batch/capture_converter.h"
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "status_macros.h"
+
+ABSL_FLAG(std::string, input, "",
+          "Directory with *.txtpb captures or a glob pattern.");
+ABSL_FLAG(std::string, output_dir, "",
+          "Directory for the *.scanbin files and conversion.txt.");
+ABSL_FLAG(int32_t, threads, 0, "Worker threads, 0 for all cores.");
+ABSL_FLAG(int64_t, chunk_bytes, int64_t{1} << 20,
+          "Captures are split into chunks of about this size.");
+ABSL_FLAG(bool, validate, false,
+          "Also parse with protobuf and fail captures that differ.");
+
+absl::Status Run() {
+  ASSIGN_OR_RETURN(auto files,
+                   slam_dunk::ExpandInputs(absl::GetFlag(FLAGS_input)));
+  slam_dunk::CaptureConverter::Options options;
+  options.output_dir = absl::GetFlag(FLAGS_output_dir);
+  if (options.output_dir.empty()) {
+    return absl::InvalidArgumentError("--output_dir is required");
+  }
+  options.chunk_bytes = absl::GetFlag(FLAGS_chunk_bytes);
+  options.validate = absl::GetFlag(FLAGS_validate);
+  if (absl::GetFlag(FLAGS_threads) > 0) {
+    options.num_threads = absl::GetFlag(FLAGS_threads);
+  }
+  std::error_code error;
+  std::filesystem::create_directories(options.output_dir, error);
+  if (error) {
+    return absl::InternalError(absl::StrCat(
+        "Cannot create ", options.output_dir, ": ", error.message()));
+  }
+
+  LOG(INFO) << "Converting " << files.size() << " captures";
+  const auto summary = slam_dunk::CaptureConverter(options).Run(files);
+  LOG(INFO) << summary.ToString();
+  std::ofstream report(
+      std::filesystem::path(options.output_dir) / "conversion.txt");
+  report << summary.ToString();
+  for (const auto& file : summary.files) {
+    if (!file.status.ok()) {
+      return absl::DataLossError("Some captures failed, see conversion.txt");
+    }
+  }
+  return absl::OkStatus();
+}
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(*argv);
+  absl::ParseCommandLine(argc, argv);
+  gflags::SetCommandLineOption("logtostderr", "1");
+
+  if (auto status = Run(); !status.ok()) {
+    LOG(ERROR) << status.message();
+    return EXIT_FAILURE;
+  }
+  LOG(INFO) << "Done.";
+  return EXIT_SUCCESS;
+}
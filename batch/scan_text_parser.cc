@@ -0,0 +1,161 @@
+#include "batch/scan_text_parser.h"
+#include <cstdint>
+#include "absl/strings/str_format.h"
+#include "proto_utils.h"
+
+namespace slam_dunk {
+namespace {
+
+// Cursor over the text with the few tokens the layout has.
+class Scanner {
+ public:
+  explicit Scanner(absl::string_view text)
+      : p_(text.data()), end_(text.data() + text.size()), begin_(p_) {}
+
+  bool AtEnd() {
+    SkipSpace();
+    return p_ == end_;
+  }
+
+  bool Consume(char c) {
+    SkipSpace();
+    if (p_ == end_ || *p_ != c) return false;
+    ++p_;
+    return true;
+  }
+
+  // Identifier of letters, digits and underscores.
+  absl::string_view Name() {
+    SkipSpace();
+    const char* start = p_;
+    while (p_ != end_ && (IsLetter(*p_) || *p_ == '_' || IsDigit(*p_))) ++p_;
+    return absl::string_view(start, p_ - start);
+  }
+
+  // Decimal number that fits 32 bits. TextFormat reads a leading zero as
+  // octal, so such numbers are left to it.
+  bool Number(uint32_t& value) {
+    SkipSpace();
+    const char* start = p_;
+    if (end_ - p_ >= 2 && p_[0] == '0' && IsDigit(p_[1])) return false;
+    uint64_t result = 0;
+    while (p_ != end_ && IsDigit(*p_)) {
+      result = result * 10 + (*p_ - '0');
+      if (result > UINT32_MAX) return false;
+      ++p_;
+    }
+    value = static_cast<uint32_t>(result);
+    // A number runs until a space or the closing brace.
+    return p_ != start && (p_ == end_ || *p_ == '}' || IsSpace(*p_));
+  }
+
+  size_t offset() const { return p_ - begin_; }
+
+ private:
+  static bool IsSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+  }
+  static bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+  static bool IsLetter(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+  }
+  void SkipSpace() {
+    while (p_ != end_ && IsSpace(*p_)) ++p_;
+  }
+
+  const char* p_;
+  const char* end_;
+  const char* begin_;
+};
+
+enum Field : uint32_t {
+  kTheta = 1 << 0,
+  kDistance = 1 << 1,
+  kQuality = 1 << 2,
+  kFlag = 1 << 3,
+};
+
+}  // namespace
+
+std::vector<absl::string_view> SplitScanText(absl::string_view text,
+                                             size_t chunk_bytes) {
+  constexpr absl::string_view kItem = "\nitems {";
+  std::vector<absl::string_view> chunks;
+  size_t begin = 0;
+  while (begin < text.size()) {
+    size_t end = text.size();
+    if (text.size() - begin > chunk_bytes) {
+      const size_t next = text.find(kItem, begin + chunk_bytes);
+      if (next != absl::string_view::npos) end = next + 1;
+    }
+    chunks.push_back(text.substr(begin, end - begin));
+    begin = end;
+  }
+  return chunks;
+}
+
+absl::Status ParseScanItems(absl::string_view text,
+                            std::vector<ScanResponse>& scan) {
+  const size_t size = scan.size();
+  Scanner scanner(text);
+  auto error = [&](absl::string_view what) {
+    scan.resize(size);
+    return absl::InvalidArgumentError(
+        absl::StrFormat("%s at offset %d", what, scanner.offset()));
+  };
+
+  while (!scanner.AtEnd()) {
+    if (scanner.Name() != "items" || !scanner.Consume('{')) {
+      return error("Expected `items {`");
+    }
+    ScanResponse& response = scan.emplace_back();
+    response = {};
+    uint32_t seen = 0;
+    while (!scanner.Consume('}')) {
+      const absl::string_view name = scanner.Name();
+      uint32_t value = 0;
+      if (!scanner.Consume(':') || !scanner.Number(value)) {
+        return error("Expected `name: number`");
+      }
+      Field field;
+      uint32_t max = UINT32_MAX;
+      if (name == "theta") {
+        field = kTheta;
+        max = UINT16_MAX;
+        response.theta = static_cast<uint16_t>(value);
+      } else if (name == "distance_mm") {
+        field = kDistance;
+        response.distance_mm = value;
+      } else if (name == "quality") {
+        field = kQuality;
+        max = UINT8_MAX;
+        response.quality = static_cast<uint8_t>(value);
+      } else if (name == "flag") {
+        field = kFlag;
+        max = UINT8_MAX;
+        response.flag = static_cast<uint8_t>(value);
+      } else {
+        return error("Unknown field");
+      }
+      // Out of range values are truncated by the protobuf path; repeated
+      // fields are an error there. Leave both to it.
+      if (value > max || (seen & field)) return error("Unexpected value");
+      seen |= field;
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ParseScanText(absl::string_view text,
+                           std::vector<ScanResponse>& scan,
+                           bool& used_fallback) {
+  used_fallback = false;
+  if (ParseScanItems(text, scan).ok()) return absl::OkStatus();
+  used_fallback = true;
+  auto parsed = ConvertTextProtoStringToScanResponse(text);
+  if (!parsed.ok()) return parsed.status();
+  scan.insert(scan.end(), parsed->begin(), parsed->end());
+  return absl::OkStatus();
+}
+
+}  // namespace slam_dunk
@@ -0,0 +1,34 @@
+// Fast parsing of scans saved as text proto by SaveToFile.
+#ifndef SLAM_DUNK_BATCH_SCAN_TEXT_PARSER_H_
+#define SLAM_DUNK_BATCH_SCAN_TEXT_PARSER_H_
+#include <cstddef>
+#include <vector>
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "lidar.h"
+
+namespace slam_dunk {
+
+// Splits `text` into pieces of about `chunk_bytes` that each start at an
+// `items {` line, so that every piece is a valid ScanResponse text proto on
+// its own and they can be parsed independently.
+std::vector<absl::string_view> SplitScanText(absl::string_view text,
+                                             size_t chunk_bytes);
+
+// Parses the `items { theta: 1 distance_mm: 2 quality: 3 flag: 4 }` layout
+// that SaveToFile writes and appends the samples to `scan`. Whenever it
+// succeeds the result equals TextFormat parsing; anything else, such as
+// comments, other spellings or out of range values, is InvalidArgument and
+// `scan` is left as it was.
+absl::Status ParseScanItems(absl::string_view text,
+                            std::vector<ScanResponse>& scan);
+
+// ParseScanItems, falling back to the protobuf parser when it fails. Sets
+// `used_fallback` accordingly.
+absl::Status ParseScanText(absl::string_view text,
+                           std::vector<ScanResponse>& scan,
+                           bool& used_fallback);
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_BATCH_SCAN_TEXT_PARSER_H_
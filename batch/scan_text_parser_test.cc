@@ -0,0 +1,127 @@
+#include "batch/scan_text_parser.h"
+#include <string>
+#include <vector>
+#include "absl/status/status_matchers.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock-matchers.h"
+#include "gtest/gtest.h"
+#include "proto_utils.h"
+#include "simulated_scan.h"
+
+namespace slam_dunk {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+using ::testing::SizeIs;
+
+MATCHER_P(SameSample, expected, "") {
+  return arg.theta == expected.theta &&
+         arg.distance_mm == expected.distance_mm &&
+         arg.quality == expected.quality && arg.flag == expected.flag;
+}
+
+void ExpectSameScan(const std::vector<ScanResponse>& actual,
+                    const std::vector<ScanResponse>& expected) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); ++i) {
+    ASSERT_THAT(actual[i], SameSample(expected[i])) << "sample " << i;
+  }
+}
+
+// A revolution with empty samples and a sync flag, as SaveToFile writes it.
+std::string Capture(std::vector<ScanResponse>* scan = nullptr) {
+  auto samples = SimulateScan(SimulatedWorld::Room(6, 4),
+                              Pose2d{.x = 1, .y = 2}, 2048, 0.005);
+  for (size_t i = 0; i < samples.size(); i += 7) samples[i].distance_mm = 0;
+  if (scan != nullptr) *scan = samples;
+  return ConvertScanResponseToTextProtoString(samples).value();
+}
+
+TEST(ParseScanItems, MatchesProtobuf) {
+  const std::string text = Capture();
+  std::vector<ScanResponse> scan;
+  ASSERT_THAT(ParseScanItems(text, scan), IsOk());
+  ExpectSameScan(scan, ConvertTextProtoStringToScanResponse(text).value());
+}
+
+TEST(ParseScanItems, Appends) {
+  std::vector<ScanResponse> scan(3);
+  ASSERT_THAT(ParseScanItems("items {\n  theta: 7\n}\n", scan), IsOk());
+  ASSERT_THAT(scan, SizeIs(4));
+  EXPECT_EQ(scan[3].theta, 7);
+  EXPECT_EQ(scan[3].distance_mm, 0);
+}
+
+TEST(ParseScanItems, RejectsWhatItDoesNotKnow) {
+  for (const char* text : {
+           "items { theta: 1 }  # comment",
+           "items: { theta: 1 }",
+           "items { theta: 0x10 }",
+           "items { theta: 010 }",
+           "items { theta: 70000 }",
+           "items { theta: 1 theta: 2 }",
+           "items { angle: 1 }",
+           "items { theta: 1 ",
+       }) {
+    std::vector<ScanResponse> scan(1);
+    EXPECT_THAT(ParseScanItems(text, scan),
+                StatusIs(absl::StatusCode::kInvalidArgument))
+        << text;
+    EXPECT_THAT(scan, SizeIs(1)) << text;
+  }
+}
+
+TEST(ParseScanText, OctalGoesToProtobuf) {
+  std::vector<ScanResponse> scan;
+  bool used_fallback = false;
+  ASSERT_THAT(ParseScanText("items { theta: 010 distance_mm: 0 }", scan,
+                            used_fallback),
+              IsOk());
+  EXPECT_TRUE(used_fallback);
+  ASSERT_THAT(scan, SizeIs(1));
+  EXPECT_EQ(scan[0].theta, 8);
+  EXPECT_EQ(scan[0].distance_mm, 0);
+}
+
+TEST(ParseScanText, FallsBackToProtobuf) {
+  const std::string text = "# Saved by hand\nitems: { flag: 1 theta: 0x10 }\n";
+  std::vector<ScanResponse> scan;
+  bool used_fallback = false;
+  ASSERT_THAT(ParseScanText(text, scan, used_fallback), IsOk());
+  EXPECT_TRUE(used_fallback);
+  ExpectSameScan(scan, ConvertTextProtoStringToScanResponse(text).value());
+}
+
+TEST(ParseScanText, Garbage) {
+  std::vector<ScanResponse> scan;
+  bool used_fallback = false;
+  EXPECT_THAT(ParseScanText("items { theta: -1 }", scan, used_fallback),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(SplitScanText, ChunksStartAtItems) {
+  std::vector<ScanResponse> expected;
+  const std::string text = Capture(&expected);
+  const std::vector<absl::string_view> chunks = SplitScanText(text, 4096);
+  ASSERT_GT(chunks.size(), 10);
+
+  std::string joined;
+  std::vector<ScanResponse> scan;
+  for (absl::string_view chunk : chunks) {
+    EXPECT_TRUE(absl::StartsWith(chunk, "items {"));
+    absl::StrAppend(&joined, chunk);
+    ASSERT_THAT(ParseScanItems(chunk, scan), IsOk());
+  }
+  EXPECT_EQ(joined, text);
+  ExpectSameScan(scan, expected);
+}
+
+TEST(SplitScanText, SmallTextIsOneChunk) {
+  EXPECT_THAT(SplitScanText("items {\n}\n", 4096), SizeIs(1));
+  EXPECT_THAT(SplitScanText("", 4096), SizeIs(0));
+}
+
+}  // namespace
+}  // namespace slam_dunk
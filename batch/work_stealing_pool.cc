@@ -0,0 +1,106 @@
+#include "batch/work_stealing_pool.h"
+#include <algorithm>
+
+namespace slam_dunk {
+namespace {
+
+// Worker identity of the current thread, for scheduling from tasks.
+thread_local const WorkStealingPool* current_pool = nullptr;
+thread_local int32_t current_index = -1;
+
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(int32_t num_threads) {
+  num_threads = std::max(num_threads, 1);
+  for (int32_t i = 0; i < num_threads; ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  for (int32_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  Wait();
+  done_ = true;
+  {
+    absl::MutexLock lock(&mutex_);
+    work_.SignalAll();
+  }
+  for (auto& thread : threads_) thread.join();
+}
+
+void WorkStealingPool::Schedule(std::function<void()> task) {
+  // Counted before the task becomes visible, so that Wait cannot see zero
+  // while a running task is spawning more.
+  ++pending_;
+  const int32_t index =
+      current_pool == this
+          ? current_index
+          : static_cast<int32_t>(next_queue_++ % queues_.size());
+  {
+    Queue& queue = *queues_[index];
+    absl::MutexLock lock(&queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  // Pairs with WorkerLoop, which raises sleepers_ before checking queued_:
+  // either the worker sees the task or this sees the sleeper.
+  ++queued_;
+  if (sleepers_ > 0) {
+    absl::MutexLock lock(&mutex_);
+    work_.Signal();
+  }
+}
+
+void WorkStealingPool::Wait() {
+  absl::MutexLock lock(&mutex_);
+  while (pending_ > 0) idle_.Wait(&mutex_);
+}
+
+bool WorkStealingPool::TryPop(int32_t index, std::function<void()>& task) {
+  {
+    Queue& own = *queues_[index];
+    absl::MutexLock lock(&own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+  const int32_t n = static_cast<int32_t>(queues_.size());
+  for (int32_t k = 1; k < n; ++k) {
+    Queue& victim = *queues_[(index + k) % n];
+    absl::MutexLock lock(&victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      ++steals_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::WorkerLoop(int32_t index) {
+  current_pool = this;
+  current_index = index;
+  while (true) {
+    std::function<void()> task;
+    if (TryPop(index, task)) {
+      --queued_;
+      task();
+      if (--pending_ == 0) {
+        absl::MutexLock lock(&mutex_);
+        idle_.SignalAll();
+      }
+      continue;
+    }
+    absl::MutexLock lock(&mutex_);
+    ++sleepers_;
+    while (queued_ <= 0 && !done_) work_.Wait(&mutex_);
+    --sleepers_;
+    if (done_ && queued_ <= 0) return;
+  }
+}
+
+}  // namespace slam_dunk
@@ -0,0 +1,77 @@
+// Thread pool with per-worker queues and work stealing.
+#ifndef SLAM_DUNK_BATCH_WORK_STEALING_POOL_H_
+#define SLAM_DUNK_BATCH_WORK_STEALING_POOL_H_
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace slam_dunk {
+
+// Each worker owns a deque. Tasks scheduled from a worker go to its own
+// deque and are taken newest first, which keeps a file and its chunks on
+// one core; idle workers steal the oldest task from other deques, so large
+// files do not leave cores idle at the end of a batch.
+class WorkStealingPool {
+ public:
+  // Starts `num_threads` workers, at least one.
+  explicit WorkStealingPool(int32_t num_threads);
+  // Waits for the scheduled tasks and joins the workers.
+  ~WorkStealingPool();
+
+  // Queues task. Can be called from tasks.
+  void Schedule(std::function<void()> task);
+
+  // Blocks until all scheduled tasks, including the ones they scheduled,
+  // have finished. Must not be called from a task.
+  void Wait();
+
+  int32_t num_threads() const { return static_cast<int32_t>(threads_.size()); }
+
+  // Number of tasks taken from another worker's deque.
+  int64_t steals() const { return steals_; }
+
+  // Not copyable
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+ private:
+  struct Queue {
+    absl::Mutex mutex;
+    std::deque<std::function<void()>> tasks ABSL_GUARDED_BY(mutex);
+  };
+
+  void WorkerLoop(int32_t index);
+  // Pops from own deque or steals from others.
+  bool TryPop(int32_t index, std::function<void()>& task);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+
+  // Counters are atomic so that scheduling and popping only lock the deques
+  // involved; mutex_ is taken only to put threads to sleep and wake them.
+  // Scheduled and not finished.
+  std::atomic<int64_t> pending_ = 0;
+  // Sitting in deques. Can be briefly negative while Schedule races a pop.
+  std::atomic<int64_t> queued_ = 0;
+  std::atomic<int64_t> steals_ = 0;
+  std::atomic<uint32_t> next_queue_ = 0;
+  // Workers blocked or about to block on work_.
+  std::atomic<int32_t> sleepers_ = 0;
+  std::atomic<bool> done_ = false;
+
+  absl::Mutex mutex_;
+  // Signalled when tasks are queued or the pool shuts down.
+  absl::CondVar work_;
+  // Signalled when pending_ drops to zero.
+  absl::CondVar idle_;
+};
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_BATCH_WORK_STEALING_POOL_H_
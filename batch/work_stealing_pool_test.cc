@@ -0,0 +1,58 @@
+#include "batch/work_stealing_pool.h"
+#include <atomic>
+#include "gtest/gtest.h"
+
+namespace slam_dunk {
+namespace {
+
+TEST(WorkStealingPool, RunsAllTasks) {
+  std::atomic<int32_t> count = 0;
+  WorkStealingPool pool(4);
+  for (int32_t i = 0; i < 1000; ++i) pool.Schedule([&] { ++count; });
+  pool.Wait();
+  EXPECT_EQ(count, 1000);
+}
+
+TEST(WorkStealingPool, WaitsForNestedTasks) {
+  std::atomic<int32_t> count = 0;
+  WorkStealingPool pool(4);
+  for (int32_t i = 0; i < 10; ++i) {
+    pool.Schedule([&] {
+      for (int32_t j = 0; j < 100; ++j) {
+        pool.Schedule([&] { ++count; });
+      }
+    });
+  }
+  pool.Wait();
+  EXPECT_EQ(count, 1000);
+}
+
+TEST(WorkStealingPool, IdleWorkersSteal) {
+  std::atomic<int32_t> count = 0;
+  WorkStealingPool pool(4);
+  // All subtasks land in one worker's deque.
+  pool.Schedule([&] {
+    for (int32_t j = 0; j < 200; ++j) {
+      pool.Schedule([&] {
+        volatile double sink = 0;
+        for (int32_t k = 0; k < 100000; ++k) sink = sink + k;
+        ++count;
+      });
+    }
+  });
+  pool.Wait();
+  EXPECT_EQ(count, 200);
+  EXPECT_GT(pool.steals(), 0);
+}
+
+TEST(WorkStealingPool, DestructorWaits) {
+  std::atomic<int32_t> count = 0;
+  {
+    WorkStealingPool pool(2);
+    for (int32_t i = 0; i < 100; ++i) pool.Schedule([&] { ++count; });
+  }
+  EXPECT_EQ(count, 100);
+}
+
+}  // namespace
+}  // namespace slam_dunk
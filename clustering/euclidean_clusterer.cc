@@ -0,0 +1,253 @@
+#include "clustering/euclidean_clusterer.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "scan_geometry.h"
+
+namespace slam_dunk {
+namespace {
+
+// Smallest tolerance whose cells still number the farthest possible sample,
+// UINT32_MAX / 4000 m away, within int32_t.
+constexpr double kMinToleranceM = 0.001;
+
+// Cells that may hold points within the tolerance of a point in cell (0, 0),
+// when cells are tolerance / sqrt(2) wide. Only half of the 5 x 5 block
+// without corners is listed, the other half is visited from the other cell.
+constexpr int32_t kNeighbours[][2] = {
+    {1, 0},  {2, 0},  {-2, 1}, {-1, 1}, {0, 1},
+    {1, 1},  {2, 1},  {-1, 2}, {0, 2},  {1, 2},
+};
+
+int64_t CellKey(int32_t ix, int32_t iy) {
+  return (static_cast<int64_t>(ix) << 32) | static_cast<uint32_t>(iy);
+}
+
+int32_t CellX(int64_t key) { return static_cast<int32_t>(key >> 32); }
+int32_t CellY(int64_t key) { return static_cast<int32_t>(key & 0xffffffff); }
+
+size_t HashOf(int64_t key, int32_t shift) {
+  return (static_cast<uint64_t>(key) * 0x9e3779b97f4a7c15ull) >> shift;
+}
+
+}  // namespace
+
+absl::StatusOr<EuclideanClusterer> EuclideanClusterer::Create(
+    const Options& options) {
+  // Cells are tolerance / sqrt(2) wide and numbered by int32_t.
+  if (!(options.tolerance_m >= kMinToleranceM) ||
+      !std::isfinite(options.tolerance_m)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Tolerance must be finite and at least %g m: %g", kMinToleranceM,
+        options.tolerance_m));
+  }
+  if (options.min_points < 1) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Minimum number of points must be positive: %d", options.min_points));
+  }
+  return EuclideanClusterer(options);
+}
+
+EuclideanClusterer::EuclideanClusterer(const Options& options)
+    : options_(options),
+      cell_size_m_(options.tolerance_m / std::sqrt(2.0)),
+      tolerance_sq_(options.tolerance_m * options.tolerance_m) {}
+
+std::vector<PointCluster> EuclideanClusterer::Cluster(
+    const std::vector<ScanResponse>& scan) {
+  std::vector<PointCluster> clusters;
+  Cluster(scan, clusters);
+  return clusters;
+}
+
+void EuclideanClusterer::Cluster(const std::vector<ScanResponse>& scan,
+                                 std::vector<PointCluster>& clusters) {
+  clusters.clear();
+  labels_.assign(scan.size(), -1);
+  BuildRuns(scan);
+  if (points_.empty()) return;
+  BuildGrid();
+  JoinCells();
+
+  // Roots are the smallest run of their cluster, so visiting runs in order
+  // numbers clusters by their first point.
+  const int32_t num_runs = parents_.size();
+  for (int32_t run = 0; run < num_runs; ++run) {
+    const int32_t root = Find(run);
+    if (root != run) run_sizes_[root] += run_sizes_[run];
+  }
+  run_clusters_.assign(num_runs, -1);
+  for (int32_t run = 0; run < num_runs; ++run) {
+    const int32_t root = Find(run);
+    if (run_sizes_[root] < options_.min_points) continue;
+    if (root == run) {
+      run_clusters_[run] = clusters.size();
+      clusters.emplace_back();
+      clusters.back().first_index = indices_[run_begins_[run]];
+      clusters.back().min_corner.setConstant(
+          std::numeric_limits<double>::infinity());
+      clusters.back().max_corner.setConstant(
+          -std::numeric_limits<double>::infinity());
+    } else {
+      run_clusters_[run] = run_clusters_[root];
+    }
+  }
+
+  const int32_t num_points = points_.size();
+  for (int32_t i = 0; i < num_points; ++i) {
+    const int32_t label = run_clusters_[point_runs_[i]];
+    if (label < 0) continue;
+    labels_[indices_[i]] = label;
+    PointCluster& cluster = clusters[label];
+    const Eigen::Vector2d& p = points_[i];
+    ++cluster.num_points;
+    cluster.centroid += p;
+    cluster.min_corner = cluster.min_corner.cwiseMin(p);
+    cluster.max_corner = cluster.max_corner.cwiseMax(p);
+  }
+  for (auto& cluster : clusters) cluster.centroid /= cluster.num_points;
+  // Second pass around the centroid avoids cancellation of raw moments for
+  // small objects far from the lidar.
+  for (int32_t i = 0; i < num_points; ++i) {
+    const int32_t label = run_clusters_[point_runs_[i]];
+    if (label < 0) continue;
+    PointCluster& cluster = clusters[label];
+    const Eigen::Vector2d d = points_[i] - cluster.centroid;
+    cluster.covariance.noalias() += d * d.transpose();
+  }
+  for (auto& cluster : clusters) cluster.covariance /= cluster.num_points;
+}
+
+void EuclideanClusterer::BuildRuns(const std::vector<ScanResponse>& scan) {
+  points_.clear();
+  indices_.clear();
+  point_runs_.clear();
+  parents_.clear();
+  run_sizes_.clear();
+  run_begins_.clear();
+
+  const int32_t size = scan.size();
+  for (int32_t i = 0; i < size; ++i) {
+    if (!IsValid(scan[i])) continue;
+    const Eigen::Vector2d p = ToCartesian(scan[i]);
+    if (points_.empty() ||
+        (p - points_.back()).squaredNorm() > tolerance_sq_) {
+      run_begins_.push_back(points_.size());
+      parents_.push_back(parents_.size());
+      run_sizes_.push_back(0);
+    }
+    ++run_sizes_.back();
+    point_runs_.push_back(parents_.size() - 1);
+    points_.push_back(p);
+    indices_.push_back(i);
+  }
+}
+
+void EuclideanClusterer::BuildGrid() {
+  const size_t num_points = points_.size();
+  // Load factor stays below one half even if every point has its own cell.
+  const size_t capacity = std::max<size_t>(16, std::bit_ceil(2 * num_points));
+  table_shift_ = 64 - std::countr_zero(capacity);
+  table_.assign(capacity, -1);
+  cells_.clear();
+  point_cells_.resize(num_points);
+
+  const double inverse_size = 1.0 / cell_size_m_;
+  for (size_t i = 0; i < num_points; ++i) {
+    const int32_t ix =
+        static_cast<int32_t>(std::floor(points_[i].x() * inverse_size));
+    const int32_t iy =
+        static_cast<int32_t>(std::floor(points_[i].y() * inverse_size));
+    const int64_t key = CellKey(ix, iy);
+    size_t slot = HashOf(key, table_shift_);
+    while (table_[slot] >= 0 && cells_[table_[slot]].key != key) {
+      slot = (slot + 1) & (capacity - 1);
+    }
+    if (table_[slot] < 0) {
+      table_[slot] = cells_.size();
+      cells_.push_back({.key = key});
+    }
+    point_cells_[i] = table_[slot];
+    ++cells_[table_[slot]].count;
+  }
+
+  // Counting sort of points by cell.
+  int32_t begin = 0;
+  for (auto& cell : cells_) {
+    cell.begin = begin;
+    begin += cell.count;
+    cell.count = 0;
+  }
+  order_.resize(num_points);
+  for (size_t i = 0; i < num_points; ++i) {
+    Cell& cell = cells_[point_cells_[i]];
+    order_[cell.begin + cell.count++] = i;
+  }
+}
+
+int32_t EuclideanClusterer::FindCell(int64_t key) const {
+  size_t slot = HashOf(key, table_shift_);
+  while (table_[slot] >= 0) {
+    if (cells_[table_[slot]].key == key) return table_[slot];
+    slot = (slot + 1) & (table_.size() - 1);
+  }
+  return -1;
+}
+
+void EuclideanClusterer::JoinCells() {
+  // Points of one cell are at most tolerance apart.
+  for (const auto& cell : cells_) {
+    const int32_t run = point_runs_[order_[cell.begin]];
+    for (int32_t k = 1; k < cell.count; ++k) {
+      Join(run, point_runs_[order_[cell.begin + k]]);
+    }
+  }
+  for (const auto& cell : cells_) {
+    const int32_t ix = CellX(cell.key);
+    const int32_t iy = CellY(cell.key);
+    const int32_t run = point_runs_[order_[cell.begin]];
+    for (const auto& [dx, dy] : kNeighbours) {
+      const int32_t other = FindCell(CellKey(ix + dx, iy + dy));
+      if (other < 0) continue;
+      const int32_t other_run = point_runs_[order_[cells_[other].begin]];
+      if (Find(run) == Find(other_run)) continue;
+      if (AnyWithinTolerance(cell, cells_[other])) Join(run, other_run);
+    }
+  }
+}
+
+bool EuclideanClusterer::AnyWithinTolerance(const Cell& a,
+                                            const Cell& b) const {
+  for (int32_t i = a.begin; i < a.begin + a.count; ++i) {
+    const Eigen::Vector2d& p = points_[order_[i]];
+    for (int32_t j = b.begin; j < b.begin + b.count; ++j) {
+      if ((p - points_[order_[j]]).squaredNorm() <= tolerance_sq_) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+int32_t EuclideanClusterer::Find(int32_t run) {
+  while (parents_[run] != run) {
+    parents_[run] = parents_[parents_[run]];
+    run = parents_[run];
+  }
+  return run;
+}
+
+void EuclideanClusterer::Join(int32_t a, int32_t b) {
+  a = Find(a);
+  b = Find(b);
+  if (a < b) {
+    parents_[b] = a;
+  } else if (b < a) {
+    parents_[a] = b;
+  }
+}
+
+}  // namespace slam_dunk
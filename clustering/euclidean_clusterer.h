@@ -0,0 +1,117 @@
+// Segmentation of one lidar revolution into objects.
+#ifndef SLAM_DUNK_CLUSTERING_EUCLIDEAN_CLUSTERER_H_
+#define SLAM_DUNK_CLUSTERING_EUCLIDEAN_CLUSTERER_H_
+#include <cstdint>
+#include <vector>
+#include <Eigen/Core>
+#include "absl/status/statusor.h"
+#include "lidar.h"
+
+namespace slam_dunk {
+
+// Group of points such as a leg, a pallet or a piece of wall.
+struct PointCluster {
+  // Scan index of the first point in angular order.
+  int32_t first_index = 0;
+  int32_t num_points = 0;
+  // Mean position in the lidar frame.
+  Eigen::Vector2d centroid = Eigen::Vector2d::Zero();
+  // Axis-aligned bounding box in the lidar frame.
+  Eigen::Vector2d min_corner = Eigen::Vector2d::Zero();
+  Eigen::Vector2d max_corner = Eigen::Vector2d::Zero();
+  // Covariance of the point positions around the centroid.
+  Eigen::Matrix2d covariance = Eigen::Matrix2d::Zero();
+
+  Eigen::Vector2d Extent() const { return max_corner - min_corner; }
+};
+
+// Euclidean clustering: two points are in the same cluster if a chain of
+// points, each within the tolerance of the next, connects them.
+//
+// Neighbouring beams are usually neighbouring points, so consecutive points
+// within the tolerance are first joined into runs without any search. A
+// spatial hash grid with cells of tolerance / sqrt(2) then joins runs that
+// touch elsewhere, e.g. an object split by an occluding leg. All points of a
+// cell are within the tolerance of each other, so a cell is joined as a whole
+// and neighbouring cells are only compared while they are still in different
+// clusters. Everything is linear in the number of points and buffers are
+// reused between revolutions.
+class EuclideanClusterer {
+ public:
+  struct Options {
+    // Points closer than this belong to the same cluster.
+    double tolerance_m = 0.1;
+    // Clusters with fewer points are dropped.
+    int32_t min_points = 3;
+  };
+
+  // Fails unless tolerance_m is finite and at least 1 mm and min_points is
+  // at least 1.
+  static absl::StatusOr<EuclideanClusterer> Create(const Options& options);
+  static absl::StatusOr<EuclideanClusterer> Create() {
+    return Create(Options());
+  }
+
+  // Returns clusters of a scan sorted by theta, e.g. from Lidar::Scan,
+  // ordered by their first point. Samples with zero distance are skipped.
+  std::vector<PointCluster> Cluster(const std::vector<ScanResponse>& scan);
+
+  // Same as above, but reuses `clusters` storage between revolutions.
+  void Cluster(const std::vector<ScanResponse>& scan,
+               std::vector<PointCluster>& clusters);
+
+  // Cluster index of each sample of the latest scan, -1 for samples that
+  // are invalid or in a dropped cluster.
+  const std::vector<int32_t>& labels() const { return labels_; }
+
+ private:
+  explicit EuclideanClusterer(const Options& options);
+
+  // Occupied grid cell and its points in order_[begin, begin + count).
+  struct Cell {
+    int64_t key = 0;
+    int32_t begin = 0;
+    int32_t count = 0;
+  };
+
+  // Converts valid samples into points_ and joins consecutive ones in runs.
+  void BuildRuns(const std::vector<ScanResponse>& scan);
+  // Buckets points into cells_ through the hash table.
+  void BuildGrid();
+  // Returns index in cells_ or -1.
+  int32_t FindCell(int64_t key) const;
+  // Joins runs of neighbouring cells with points within the tolerance.
+  void JoinCells();
+  bool AnyWithinTolerance(const Cell& a, const Cell& b) const;
+
+  // Union-find over runs with path halving.
+  int32_t Find(int32_t run);
+  void Join(int32_t a, int32_t b);
+
+  Options options_;
+  double cell_size_m_;
+  double tolerance_sq_;
+
+  // Reused between calls to avoid allocations per revolution.
+  // Per valid point: position, scan index, run and cell.
+  std::vector<Eigen::Vector2d> points_;
+  std::vector<int32_t> indices_;
+  std::vector<int32_t> point_runs_;
+  std::vector<int32_t> point_cells_;
+  // Per run: union-find parent, first point, number of points and cluster.
+  std::vector<int32_t> parents_;
+  std::vector<int32_t> run_begins_;
+  std::vector<int32_t> run_sizes_;
+  std::vector<int32_t> run_clusters_;
+  // Open addressing table of indices into cells_, -1 when empty.
+  std::vector<int32_t> table_;
+  int32_t table_shift_ = 0;
+  std::vector<Cell> cells_;
+  // Points sorted by cell.
+  std::vector<int32_t> order_;
+  std::vector<int32_t> labels_;
+};
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_CLUSTERING_EUCLIDEAN_CLUSTERER_H_
@@ -0,0 +1,71 @@
+// Clustering time per revolution.
+// blaze run -c opt //clustering:euclidean_clusterer_benchmark
+#include <random>
+#include <utility>
+#include <benchmark/benchmark.h>
+#include "clustering/euclidean_clusterer.h"
+#include "simulated_scan.h"
+
+namespace slam_dunk {
+namespace {
+
+// Warehouse aisle with a few people and a pallet.
+SimulatedWorld MakeWorld() {
+  SimulatedWorld world = SimulatedWorld::Room(12, 8);
+  world.walls.push_back({{6, 0}, {6, 3}});
+  world.walls.push_back({{6, 5}, {6, 8}});
+  world.walls.push_back({{8, 2}, {9.2, 2}});
+  world.walls.push_back({{9.2, 2}, {9.2, 3}});
+  for (const auto& [x, y] : {std::pair{2.0, 2.0}, std::pair{2.25, 2.1},
+                              std::pair{4.0, 6.0}, std::pair{4.2, 6.2},
+                              std::pair{8.0, 5.0}, std::pair{8.1, 5.3}}) {
+    world.circles.push_back({{x, y}, 0.06});
+  }
+  return world;
+}
+
+// Many small objects, e.g. chair legs, so that runs are short and most of
+// the work falls on the grid.
+SimulatedWorld MakeClutter() {
+  SimulatedWorld world = SimulatedWorld::Room(12, 8);
+  std::mt19937 random(1);
+  std::uniform_real_distribution<double> x(0.5, 11.5);
+  std::uniform_real_distribution<double> y(0.5, 7.5);
+  for (int32_t i = 0; i < 300; ++i) {
+    world.circles.push_back({{x(random), y(random)}, 0.03});
+  }
+  return world;
+}
+
+void BM_ClusterRevolution(benchmark::State& state) {
+  const auto scan = SimulateScan(MakeWorld(), Pose2d{.x = 3, .y = 4},
+                                 state.range(0), /*range_sigma_m=*/0.01);
+  EuclideanClusterer clusterer = *EuclideanClusterer::Create();
+  std::vector<PointCluster> clusters;
+  for (auto _ : state) {
+    clusterer.Cluster(scan, clusters);
+    benchmark::DoNotOptimize(clusters.data());
+  }
+  state.counters["clusters"] = clusters.size();
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ClusterRevolution)->Arg(2048)->Arg(4096)->Arg(8192);
+
+void BM_ClusterClutter(benchmark::State& state) {
+  const auto scan = SimulateScan(MakeClutter(), Pose2d{.x = 6, .y = 4},
+                                 state.range(0), /*range_sigma_m=*/0.01);
+  EuclideanClusterer clusterer = *EuclideanClusterer::Create();
+  std::vector<PointCluster> clusters;
+  for (auto _ : state) {
+    clusterer.Cluster(scan, clusters);
+    benchmark::DoNotOptimize(clusters.data());
+  }
+  state.counters["clusters"] = clusters.size();
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ClusterClutter)->Arg(8192);
+
+}  // namespace
+}  // namespace slam_dunk
+
+BENCHMARK_MAIN();
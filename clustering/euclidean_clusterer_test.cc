@@ -0,0 +1,190 @@
+#include "clustering/euclidean_clusterer.h"
+#include <cmath>
+#include <numeric>
+#include <utility>
+#include <Eigen/LU>
+#include "absl/status/status_matchers.h"
+#include "gmock/gmock-matchers.h"
+#include "gtest/gtest.h"
+#include "scan_geometry.h"
+#include "simulated_scan.h"
+
+namespace slam_dunk {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+using ::testing::DoubleNear;
+using ::testing::Each;
+using ::testing::SizeIs;
+
+ScanResponse Sample(double degrees, double range_m) {
+  return {.theta = static_cast<uint16_t>(degrees / 360 * kThetaFullCircle),
+          .distance_mm = static_cast<uint32_t>(range_m * 4000)};
+}
+
+EuclideanClusterer MakeClusterer(const EuclideanClusterer::Options& options) {
+  auto clusterer = EuclideanClusterer::Create(options);
+  EXPECT_THAT(clusterer, IsOk());
+  return *std::move(clusterer);
+}
+
+// Labels every valid sample by comparing all pairs.
+std::vector<int32_t> BruteForceRoots(const std::vector<ScanResponse>& scan,
+                                     double tolerance_m) {
+  std::vector<int32_t> roots(scan.size());
+  std::iota(roots.begin(), roots.end(), 0);
+  auto find = [&](int32_t i) {
+    while (roots[i] != i) i = roots[i];
+    return i;
+  };
+  for (size_t i = 0; i < scan.size(); ++i) {
+    if (!IsValid(scan[i])) continue;
+    for (size_t j = i + 1; j < scan.size(); ++j) {
+      if (!IsValid(scan[j])) continue;
+      if ((ToCartesian(scan[i]) - ToCartesian(scan[j])).norm() <=
+          tolerance_m) {
+        roots[std::max(find(i), find(j))] = std::min(find(i), find(j));
+      }
+    }
+  }
+  for (size_t i = 0; i < scan.size(); ++i) roots[i] = find(i);
+  return roots;
+}
+
+TEST(EuclideanClusterer, RejectsBadOptions) {
+  EXPECT_THAT(EuclideanClusterer::Create({.tolerance_m = 0}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(EuclideanClusterer::Create({.tolerance_m = -0.1}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(EuclideanClusterer::Create({.tolerance_m = 1e-6}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(EuclideanClusterer::Create({.tolerance_m = std::nan("")}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(EuclideanClusterer::Create({.min_points = 0}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(EuclideanClusterer::Create({.tolerance_m = 0.001}), IsOk());
+  EXPECT_THAT(EuclideanClusterer::Create(), IsOk());
+}
+
+TEST(EuclideanClusterer, SeparatesLegsFromWalls) {
+  SimulatedWorld world = SimulatedWorld::Room(8, 6);
+  world.circles.push_back({{5, 3}, 0.06});
+  world.circles.push_back({{5, 3.3}, 0.06});
+  world.circles.push_back({{2, 4}, 0.25});
+  const auto scan = SimulateScan(world, Pose2d{.x = 3, .y = 2},
+                                 /*count=*/4096, /*range_sigma_m=*/0.005);
+  EuclideanClusterer clusterer = MakeClusterer({});
+  const auto clusters = clusterer.Cluster(scan);
+  // Walls meet in corners, but shadows of the three objects cut them into
+  // three pieces.
+  ASSERT_THAT(clusters, SizeIs(6));
+
+  for (const auto& circle : world.circles) {
+    // Centroid is on the visible half, in the lidar frame.
+    const Eigen::Vector2d expected = circle.center - Eigen::Vector2d(3, 2);
+    int32_t matches = 0;
+    for (const auto& cluster : clusters) {
+      if ((cluster.centroid - expected).norm() > circle.radius) continue;
+      ++matches;
+      EXPECT_LE(cluster.Extent().maxCoeff(), 2 * circle.radius + 0.02);
+      EXPECT_GT(cluster.covariance.determinant(), 0);
+      EXPECT_TRUE(
+          (cluster.min_corner.array() <= cluster.centroid.array()).all());
+      EXPECT_TRUE(
+          (cluster.centroid.array() <= cluster.max_corner.array()).all());
+    }
+    EXPECT_EQ(matches, 1);
+  }
+}
+
+TEST(EuclideanClusterer, MatchesBruteForce) {
+  SimulatedWorld world = SimulatedWorld::Room(10, 7);
+  world.walls.push_back({{6, 0}, {6, 3}});
+  for (int32_t i = 0; i < 12; ++i) {
+    world.circles.push_back({{1.0 + 0.7 * i, 1.0 + 0.45 * i}, 0.05});
+  }
+  const auto scan = SimulateScan(world, Pose2d{.x = 4, .y = 5}, /*count=*/2048,
+                                 /*range_sigma_m=*/0.02, /*seed=*/7);
+  EuclideanClusterer clusterer =
+      MakeClusterer({.tolerance_m = 0.08, .min_points = 1});
+  clusterer.Cluster(scan);
+  const auto& labels = clusterer.labels();
+  const auto roots = BruteForceRoots(scan, 0.08);
+  for (size_t i = 0; i < scan.size(); ++i) {
+    if (!IsValid(scan[i])) {
+      EXPECT_EQ(labels[i], -1);
+      continue;
+    }
+    for (size_t j = i + 1; j < scan.size(); ++j) {
+      if (!IsValid(scan[j])) continue;
+      ASSERT_EQ(labels[i] == labels[j], roots[i] == roots[j])
+          << "samples " << i << " and " << j;
+    }
+  }
+}
+
+TEST(EuclideanClusterer, JoinsAcrossOcclusion) {
+  // Object at 2 m seen through a gap in an object at 1 m and behind a far
+  // wall sample; beams 1 degree apart are 3.5 cm apart at 2 m.
+  const std::vector<ScanResponse> scan = {
+      Sample(10, 2), Sample(11, 2), Sample(12, 5),
+      Sample(13, 2), Sample(14, 2), Sample(15, 2)};
+  EuclideanClusterer clusterer =
+      MakeClusterer({.tolerance_m = 0.1, .min_points = 1});
+  const auto clusters = clusterer.Cluster(scan);
+  ASSERT_THAT(clusters, SizeIs(2));
+  EXPECT_EQ(clusters[0].first_index, 0);
+  EXPECT_EQ(clusters[0].num_points, 5);
+  EXPECT_EQ(clusters[1].first_index, 2);
+  EXPECT_EQ(clusters[1].num_points, 1);
+  EXPECT_THAT(clusterer.labels(), testing::ElementsAre(0, 0, 1, 0, 0, 0));
+}
+
+TEST(EuclideanClusterer, JoinsStartOfRevolution) {
+  const std::vector<ScanResponse> scan = {Sample(0.5, 3), Sample(1, 3),
+                                          Sample(180, 3), Sample(359, 3),
+                                          Sample(359.5, 3)};
+  EuclideanClusterer clusterer =
+      MakeClusterer({.tolerance_m = 0.1, .min_points = 2});
+  const auto clusters = clusterer.Cluster(scan);
+  ASSERT_THAT(clusters, SizeIs(1));
+  EXPECT_EQ(clusters[0].num_points, 4);
+  EXPECT_THAT(clusters[0].centroid.x(), DoubleNear(3, 0.01));
+  EXPECT_THAT(clusters[0].centroid.y(), DoubleNear(0, 0.01));
+  EXPECT_EQ(clusterer.labels()[2], -1);
+}
+
+TEST(EuclideanClusterer, SmallestToleranceReachesFarthestSample) {
+  const std::vector<ScanResponse> scan = {
+      {.theta = 0, .distance_mm = UINT32_MAX},
+      {.theta = kThetaFullCircle / 2, .distance_mm = UINT32_MAX}};
+  EuclideanClusterer clusterer =
+      MakeClusterer({.tolerance_m = 0.001, .min_points = 1});
+  EXPECT_THAT(clusterer.Cluster(scan), SizeIs(2));
+}
+
+TEST(EuclideanClusterer, SkipsInvalidPoints) {
+  std::vector<ScanResponse> scan(100);
+  EuclideanClusterer clusterer = MakeClusterer({});
+  EXPECT_THAT(clusterer.Cluster(scan), SizeIs(0));
+  EXPECT_THAT(clusterer.labels(), Each(-1));
+}
+
+TEST(EuclideanClusterer, ReusesOutput) {
+  SimulatedWorld world = SimulatedWorld::Room(6, 4);
+  world.circles.push_back({{4, 2}, 0.1});
+  const auto scan = SimulateScan(world, Pose2d{.x = 2, .y = 2},
+                                 /*count=*/2048);
+  EuclideanClusterer clusterer = MakeClusterer({});
+  std::vector<PointCluster> clusters;
+  clusterer.Cluster(scan, clusters);
+  ASSERT_THAT(clusters, SizeIs(2));
+  const Eigen::Vector2d centroid = clusters[1].centroid;
+  clusterer.Cluster(scan, clusters);
+  ASSERT_THAT(clusters, SizeIs(2));
+  EXPECT_EQ(clusters[1].centroid, centroid);
+}
+
+}  // namespace
+}  // namespace slam_dunk
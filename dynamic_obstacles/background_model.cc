@@ -0,0 +1,133 @@
+#include "dynamic_obstacles/background_model.h"
+#include <algorithm>
+#include <cmath>
+#include "absl/strings/str_format.h"
+#include "scan_geometry.h"
+
+namespace slam_dunk {
+
+absl::StatusOr<BackgroundModel> BackgroundModel::Create(
+    const Options& options) {
+  // BinOf multiplies the 16-bit theta by num_bins in 32 bits.
+  if (options.num_bins < 1 || options.num_bins > (1 << 16)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Number of bins must be in [1, 65536]: %d", options.num_bins));
+  }
+  return BackgroundModel(options);
+}
+
+BackgroundModel::BackgroundModel(const Options& options)
+    : options_(options),
+      num_bins_(options.num_bins),
+      range_(num_bins_, 0.0f),
+      mean_(num_bins_, 0.0f),
+      variance_(num_bins_, 0.0f),
+      count_(num_bins_, 0.0f),
+      states_(num_bins_, BinState::kEmpty) {}
+
+void BackgroundModel::Update(const std::vector<ScanResponse>& scan) {
+  Bin(scan);
+  Learn();
+}
+
+void BackgroundModel::Bin(const std::vector<ScanResponse>& scan) {
+  // Zero stands for no return, as in ScanResponse.
+  std::fill(range_.begin(), range_.end(), 0.0f);
+  for (const auto& response : scan) {
+    if (!IsValid(response)) continue;
+    float& range = range_[BinOf(response.theta)];
+    const auto distance =
+        static_cast<float>(DistanceToMeters(response.distance_mm));
+    range = range == 0.0f ? distance : std::min(range, distance);
+  }
+}
+
+void BackgroundModel::Learn() {
+  const float rate = options_.learning_rate;
+  const float dynamic_rate = options_.dynamic_learning_rate;
+  const float threshold2 =
+      options_.threshold_sigmas * options_.threshold_sigmas;
+  const float min_variance = options_.min_sigma_m * options_.min_sigma_m;
+  const float warmup = options_.warmup_revolutions;
+  const int32_t num_bins = num_bins_;
+
+  const float* range = range_.data();
+  float* mean = mean_.data();
+  float* variance = variance_.data();
+  float* count = count_.data();
+  uint8_t* states = reinterpret_cast<uint8_t*>(states_.data());
+  // Conditions are kept as 0/1 floats and combined arithmetically, so that
+  // the loop has no control flow and vectorises with the copts in BUILD.
+  for (int32_t i = 0; i < num_bins; ++i) {
+    const float valid = range[i] > 0.0f ? 1.0f : 0.0f;
+    const float diff = (range[i] - mean[i]) * valid;
+    const float sigma2 = std::max(variance[i], min_variance);
+    const float closer =
+        diff * std::abs(diff) < -threshold2 * sigma2 ? 1.0f : 0.0f;
+    const float warm = count[i] >= warmup ? 1.0f : 0.0f;
+    const float dynamic = closer * warm;
+    // Running mean until warmed up, exponential forgetting afterwards.
+    const float base_rate = std::max(rate, 1.0f / (count[i] + 1.0f));
+    const float a =
+        valid * (dynamic * dynamic_rate + (1.0f - dynamic) * base_rate);
+    mean[i] += a * diff;
+    variance[i] = (1.0f - a) * (variance[i] + a * diff * diff);
+    count[i] += valid;
+    states[i] = static_cast<uint8_t>(valid + dynamic);
+  }
+}
+
+std::vector<DynamicRegion> BackgroundModel::DynamicRegions() const {
+  std::vector<DynamicRegion> regions;
+  DynamicRegions(regions);
+  return regions;
+}
+
+void BackgroundModel::DynamicRegions(
+    std::vector<DynamicRegion>& regions) const {
+  regions.clear();
+  // Start right after a non-dynamic bin, so that a region crossing zero
+  // angle is not split in two.
+  int32_t start = 0;
+  while (start < num_bins_ && states_[start] == BinState::kDynamic) ++start;
+  if (start == num_bins_) start = 0;
+
+  auto center = [&](int32_t bin, float range) -> Eigen::Vector2d {
+    const double angle = (bin + 0.5) * 2.0 * M_PI / num_bins_;
+    return {range * std::cos(angle), -range * std::sin(angle)};
+  };
+  auto close = [&](DynamicRegion& region) {
+    if (region.num_bins >= options_.min_region_bins) {
+      region.centroid /= region.num_bins;
+      regions.push_back(region);
+    }
+    region.num_bins = 0;
+  };
+
+  DynamicRegion region;
+  float last_range = 0;
+  for (int32_t k = 1; k <= num_bins_; ++k) {
+    const int32_t bin = (start + k) % num_bins_;
+    if (states_[bin] != BinState::kDynamic) {
+      close(region);
+      continue;
+    }
+    const float r = range_[bin];
+    if (region.num_bins > 0 &&
+        (center(bin, r) - center(region.last_bin, last_range)).norm() >
+            options_.max_region_gap_m) {
+      close(region);
+    }
+    if (region.num_bins == 0) {
+      region = DynamicRegion{.first_bin = bin, .min_range_m = r};
+    }
+    region.last_bin = bin;
+    region.min_range_m = std::min<double>(region.min_range_m, r);
+    region.centroid += center(bin, r);
+    ++region.num_bins;
+    last_range = r;
+  }
+  close(region);
+}
+
+}  // namespace slam_dunk
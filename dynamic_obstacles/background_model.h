@@ -0,0 +1,109 @@
+// Detection of moving objects against a per-angle background.
+#ifndef SLAM_DUNK_DYNAMIC_OBSTACLES_BACKGROUND_MODEL_H_
+#define SLAM_DUNK_DYNAMIC_OBSTACLES_BACKGROUND_MODEL_H_
+#include <cstdint>
+#include <vector>
+#include <Eigen/Core>
+#include "absl/status/statusor.h"
+#include "lidar.h"
+
+namespace slam_dunk {
+
+// Classification of one angular bin in the latest revolution.
+enum class BinState : uint8_t {
+  // No return in this bin.
+  kEmpty = 0,
+  // Range agrees with the background.
+  kStatic = 1,
+  // Something is in front of the background.
+  kDynamic = 2,
+};
+
+// Consecutive dynamic bins at similar range, e.g. legs or a forklift.
+struct DynamicRegion {
+  int32_t first_bin = 0;
+  // Inclusive, may be less than first_bin when the region wraps around zero.
+  int32_t last_bin = 0;
+  int32_t num_bins = 0;
+  // Closest range in meters.
+  double min_range_m = 0;
+  // Mean position in the lidar frame.
+  Eigen::Vector2d centroid = Eigen::Vector2d::Zero();
+};
+
+// Keeps running mean and variance of range for each angular bin across
+// revolutions of a stationary lidar. Each revolution is first reduced to the
+// closest return per bin, then all bins are classified and updated in one
+// branch-free loop over contiguous arrays. Memory is fixed at construction.
+class BackgroundModel {
+ public:
+  struct Options {
+    // Angular resolution, 720 is half a degree.
+    int32_t num_bins = 720;
+    // Weight of a new static observation in the running statistics.
+    double learning_rate = 0.05;
+    // Weight of a dynamic observation, so that parked objects slowly
+    // become background.
+    double dynamic_learning_rate = 0.002;
+    // Bins are dynamic when closer than mean - threshold_sigmas * sigma.
+    double threshold_sigmas = 3.0;
+    // Lower bound of sigma, covers the lidar range noise.
+    double min_sigma_m = 0.03;
+    // Revolutions needed before a bin can be classified as dynamic.
+    int32_t warmup_revolutions = 5;
+    // Neighbouring dynamic bins further apart than this start new region.
+    double max_region_gap_m = 0.2;
+    // Smaller regions are ignored as noise.
+    int32_t min_region_bins = 2;
+  };
+
+  // Fails if num_bins is outside [1, 65536].
+  static absl::StatusOr<BackgroundModel> Create(const Options& options);
+  static absl::StatusOr<BackgroundModel> Create() { return Create(Options()); }
+
+  // Classifies one revolution against the background and then updates the
+  // background with it.
+  void Update(const std::vector<ScanResponse>& scan);
+
+  // Returns bin of the q14 angle.
+  int32_t BinOf(uint16_t theta) const {
+    return static_cast<int32_t>((uint32_t{theta} * num_bins_) >> 16);
+  }
+
+  // State of the sample in the latest revolution.
+  BinState Classify(const ScanResponse& response) const {
+    return response.distance_mm == 0 ? BinState::kEmpty
+                                     : states_[BinOf(response.theta)];
+  }
+
+  // Per-bin states of the latest revolution.
+  const std::vector<BinState>& states() const { return states_; }
+
+  // Background range of a bin in meters.
+  float mean(int32_t bin) const { return mean_[bin]; }
+
+  // Groups dynamic bins of the latest revolution into regions.
+  std::vector<DynamicRegion> DynamicRegions() const;
+  void DynamicRegions(std::vector<DynamicRegion>& regions) const;
+
+ private:
+  explicit BackgroundModel(const Options& options);
+
+  // Reduces scan to the closest range per bin in range_.
+  void Bin(const std::vector<ScanResponse>& scan);
+  // Classifies bins and updates statistics.
+  void Learn();
+
+  Options options_;
+  int32_t num_bins_;
+  // Structure of arrays, one entry per bin.
+  std::vector<float> range_;
+  std::vector<float> mean_;
+  std::vector<float> variance_;
+  std::vector<float> count_;
+  std::vector<BinState> states_;
+};
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_DYNAMIC_OBSTACLES_BACKGROUND_MODEL_H_
@@ -0,0 +1,106 @@
+#include "dynamic_obstacles/background_model.h"
+#include <cmath>
+#include "absl/status/status_matchers.h"
+#include "gmock/gmock-matchers.h"
+#include "gmock/gmock-more-matchers.h"
+#include "gtest/gtest.h"
+#include "simulated_scan.h"
+
+namespace slam_dunk {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+using ::testing::DoubleNear;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+constexpr size_t kSamples = 2048;
+const Pose2d kPose{.x = 3, .y = 2};
+
+BackgroundModel MakeModel(const BackgroundModel::Options& options) {
+  auto model = BackgroundModel::Create(options);
+  EXPECT_THAT(model, IsOk());
+  return *std::move(model);
+}
+
+// Returns model that has seen the empty room for a while.
+BackgroundModel MakeWarmModel(const SimulatedWorld& room) {
+  BackgroundModel model = MakeModel({});
+  for (uint32_t seed = 1; seed <= 20; ++seed) {
+    model.Update(SimulateScan(room, kPose, kSamples, 0.01, seed));
+  }
+  return model;
+}
+
+TEST(BackgroundModel, RejectsBadNumberOfBins) {
+  EXPECT_THAT(BackgroundModel::Create({.num_bins = 0}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(BackgroundModel::Create({.num_bins = 70000}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(BackgroundModel, StaticRoomHasNoDynamicRegions) {
+  const SimulatedWorld room = SimulatedWorld::Room(6, 4);
+  BackgroundModel model = MakeWarmModel(room);
+  model.Update(SimulateScan(room, kPose, kSamples, 0.01, /*seed=*/100));
+  EXPECT_THAT(model.DynamicRegions(), IsEmpty());
+  for (const auto& response : SimulateScan(room, kPose, kSamples)) {
+    EXPECT_EQ(model.Classify(response), BinState::kStatic);
+  }
+}
+
+TEST(BackgroundModel, TracksMovingPerson) {
+  const SimulatedWorld room = SimulatedWorld::Room(6, 4);
+  BackgroundModel model = MakeWarmModel(room);
+
+  // Person walks along x in front of the lidar.
+  for (int32_t step = 0; step < 10; ++step) {
+    SimulatedWorld world = room;
+    const Eigen::Vector2d person(1.0 + 0.3 * step, 3.0);
+    world.circles.push_back({person, 0.2});
+    model.Update(SimulateScan(world, kPose, kSamples, 0.01, 200 + step));
+
+    const auto regions = model.DynamicRegions();
+    ASSERT_THAT(regions, SizeIs(1)) << "step " << step;
+    // Centroid is on the visible side of the person, in the lidar frame.
+    const Eigen::Vector2d expected = person - Eigen::Vector2d(kPose.x, kPose.y);
+    EXPECT_LT((regions[0].centroid - expected).norm(), 0.25) << "step " << step;
+    EXPECT_THAT(regions[0].min_range_m,
+                DoubleNear(expected.norm() - 0.2, 0.05));
+  }
+}
+
+TEST(BackgroundModel, RegionAcrossZeroAngleIsNotSplit) {
+  const SimulatedWorld room = SimulatedWorld::Room(6, 4);
+  BackgroundModel model = MakeWarmModel(room);
+  SimulatedWorld world = room;
+  // Straight ahead of the lidar, where theta wraps around.
+  world.circles.push_back({{4.5, 2.0}, 0.3});
+  model.Update(SimulateScan(world, kPose, kSamples, 0.01, 300));
+  const auto regions = model.DynamicRegions();
+  ASSERT_THAT(regions, SizeIs(1));
+  EXPECT_GT(regions[0].first_bin, regions[0].last_bin);
+  EXPECT_THAT(regions[0].centroid.y(), DoubleNear(0, 0.05));
+}
+
+TEST(BackgroundModel, ParkedObjectBecomesBackground) {
+  const SimulatedWorld room = SimulatedWorld::Room(6, 4);
+  BackgroundModel::Options options;
+  options.dynamic_learning_rate = 0.2;
+  BackgroundModel model = MakeModel(options);
+  for (uint32_t seed = 1; seed <= 20; ++seed) {
+    model.Update(SimulateScan(room, kPose, kSamples, 0.01, seed));
+  }
+  SimulatedWorld world = room;
+  world.circles.push_back({{1.5, 1.0}, 0.4});
+  model.Update(SimulateScan(world, kPose, kSamples, 0.01, 400));
+  EXPECT_THAT(model.DynamicRegions(), SizeIs(1));
+  for (uint32_t seed = 401; seed < 500; ++seed) {
+    model.Update(SimulateScan(world, kPose, kSamples, 0.01, seed));
+  }
+  EXPECT_THAT(model.DynamicRegions(), IsEmpty());
+}
+
+}  // namespace
+}  // namespace slam_dunk
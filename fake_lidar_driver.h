@@ -0,0 +1,157 @@
+// Fake RPLidar devices on fake serial ports, for tests of Lidar and
+// LidarDiscovery.
+#ifndef SLAM_DUNK__FAKE_LIDAR_DRIVER_H_
+#define SLAM_DUNK__FAKE_LIDAR_DRIVER_H_
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "lidar_driver.h"
+
+namespace slam_dunk {
+
+struct FakeDevice {
+  int32_t baud_rate = 115200;
+  uint8_t serial = 1;
+  std::vector<ScanMode> scan_modes = {
+      {.id = 0, .us_per_sample = 508, .name = "Standard"},
+      {.id = 1, .us_per_sample = 254, .name = "Express"},
+      {.id = 2, .us_per_sample = 127, .name = "Boost"}};
+  // Samples in one revolution; GrabScanDataHq stores at most this many.
+  size_t samples_per_revolution = 1600;
+  // Revolutions without returns while the motor spins up.
+  int spin_up_revolutions = 0;
+  absl::Duration revolution_time = absl::Milliseconds(5);
+};
+
+// Serial ports, some with a device attached. Every driver opened through
+// factory() talks to the port it was opened on.
+class FakeBus {
+ public:
+  void Attach(const std::string& usb_port, FakeDevice device) {
+    absl::MutexLock lock(&mutex_);
+    devices_[usb_port] = std::move(device);
+  }
+
+  DriverFactory factory() {
+    return [this](absl::string_view usb_port, int32_t baud_rate)
+               -> absl::StatusOr<std::unique_ptr<LidarDriver>> {
+      absl::MutexLock lock(&mutex_);
+      ++opened_;
+      std::optional<FakeDevice> device;
+      if (auto it = devices_.find(usb_port);
+          it != devices_.end() && it->second.baud_rate == baud_rate) {
+        device = it->second;
+      }
+      return std::make_unique<Driver>(this, std::move(device));
+    };
+  }
+
+  int opened() const {
+    absl::MutexLock lock(&mutex_);
+    return opened_;
+  }
+  int scan_mode_queries() const {
+    absl::MutexLock lock(&mutex_);
+    return scan_mode_queries_;
+  }
+  std::optional<uint16_t> started_mode() const {
+    absl::MutexLock lock(&mutex_);
+    return started_mode_;
+  }
+  // Revolutions handed out by GrabScanDataHq.
+  int grabs() const {
+    absl::MutexLock lock(&mutex_);
+    return grabs_;
+  }
+
+ private:
+  class Driver : public LidarDriver {
+   public:
+    Driver(FakeBus* bus, std::optional<FakeDevice> device)
+        : bus_(bus), device_(std::move(device)) {}
+
+    absl::StatusOr<sl_lidar_response_device_info_t> GetDeviceInfo(
+        absl::Duration timeout) override {
+      if (!device_.has_value()) {
+        // Nothing answers, or not at this baud rate.
+        absl::SleepFor(timeout);
+        return absl::UnavailableError("Timed out");
+      }
+      sl_lidar_response_device_info_t info = {};
+      info.model = 0x18;
+      info.firmware_version = 0x0118;
+      info.hardware_version = 5;
+      info.serialnum[15] = device_->serial;
+      return info;
+    }
+
+    absl::StatusOr<std::vector<ScanMode>> GetScanModes() override {
+      absl::MutexLock lock(&bus_->mutex_);
+      ++bus_->scan_mode_queries_;
+      return device_->scan_modes;
+    }
+
+    absl::Status StartScan(uint16_t scan_mode) override {
+      if (std::none_of(device_->scan_modes.begin(), device_->scan_modes.end(),
+                       [scan_mode](const ScanMode& mode) {
+                         return mode.id == scan_mode;
+                       })) {
+        return absl::InvalidArgumentError("Unsupported scan mode");
+      }
+      absl::MutexLock lock(&bus_->mutex_);
+      bus_->started_mode_ = scan_mode;
+      return absl::OkStatus();
+    }
+
+    absl::Status GrabScanDataHq(sl_lidar_response_measurement_node_hq_t* nodes,
+                                size_t& count,
+                                absl::Duration timeout) override {
+      if (timeout < device_->revolution_time) {
+        absl::SleepFor(timeout);
+        return absl::DeadlineExceededError("Timed out");
+      }
+      absl::SleepFor(device_->revolution_time);
+      {
+        absl::MutexLock lock(&bus_->mutex_);
+        ++bus_->grabs_;
+      }
+      const bool spinning_up = revolutions_++ < device_->spin_up_revolutions;
+      count = std::min(count, device_->samples_per_revolution);
+      for (size_t i = 0; i < count; ++i) {
+        nodes[i] = {};
+        nodes[i].angle_z_q14 = static_cast<uint16_t>(i * 65536 / count);
+        nodes[i].dist_mm_q2 = spinning_up ? 0 : 4000;
+        nodes[i].quality = spinning_up ? 0 : 188;
+      }
+      return absl::OkStatus();
+    }
+
+    void Stop() override {}
+
+   private:
+    FakeBus* bus_;
+    std::optional<FakeDevice> device_;
+    int revolutions_ = 0;
+  };
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, FakeDevice> devices_ ABSL_GUARDED_BY(mutex_);
+  int opened_ ABSL_GUARDED_BY(mutex_) = 0;
+  int scan_mode_queries_ ABSL_GUARDED_BY(mutex_) = 0;
+  int grabs_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::optional<uint16_t> started_mode_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK__FAKE_LIDAR_DRIVER_H_
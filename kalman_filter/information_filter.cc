@@ -0,0 +1,82 @@
+#include "kalman_filter/information_filter.h"
+
+namespace slam_dunk {
+
+InformationFilter::InformationFilter(double dt, const Eigen::MatrixXd& A,
+                                     const Eigen::MatrixXd& C,
+                                     const Eigen::MatrixXd& Q,
+                                     const Eigen::MatrixXd& R,
+                                     const Eigen::MatrixXd& P)
+    : A_(A),
+      C_(C),
+      Q_(Q),
+      P0_(P),
+      n_(A.rows()),
+      dt_(dt),
+      I_(Eigen::MatrixXd::Identity(n_, n_)),
+      Y_(n_, n_),
+      y_hat_(n_),
+      P_(n_, n_),
+      x_(n_) {
+  SetMeasurementNoiseCovariance(R);
+}
+
+void InformationFilter::SetMeasurementNoiseCovariance(
+    const Eigen::MatrixXd& noise) {
+  // Once per noise model rather than once per step.
+  ct_r_inv_ = noise.llt().solve(C_).transpose();
+  ct_r_inv_c_ = ct_r_inv_ * C_;
+}
+
+void InformationFilter::Init(double t0, const Eigen::VectorXd& x0) {
+  Y_ = P0_.llt().solve(I_);
+  y_hat_.noalias() = Y_ * x0;
+  t_ = t0;
+  initialized_ = true;
+}
+
+void InformationFilter::Init() { Init(0, Eigen::VectorXd::Zero(n_)); }
+
+bool InformationFilter::Predict() {
+  if (!initialized_) return false;
+
+  // The motion model is linear in x and P, so predict in covariance form.
+  Eigen::LLT<Eigen::MatrixXd> llt(Y_);
+  P_ = llt.solve(I_);
+  x_ = A_ * llt.solve(y_hat_);
+  P_ = A_ * P_ * A_.transpose() + Q_;
+  Y_ = P_.llt().solve(I_);
+  y_hat_.noalias() = Y_ * x_;
+
+  t_ += dt_;
+  return true;
+}
+
+bool InformationFilter::Fuse(const Eigen::MatrixXd& C,
+                             const Eigen::MatrixXd& R,
+                             const Eigen::VectorXd& y) {
+  if (!initialized_) return false;
+
+  const Eigen::MatrixXd ct_r_inv = R.llt().solve(C).transpose();
+  Y_.noalias() += ct_r_inv * C;
+  y_hat_.noalias() += ct_r_inv * y;
+  return true;
+}
+
+bool InformationFilter::Update(const Eigen::VectorXd& y) {
+  if (!Predict()) return false;
+
+  Y_ += ct_r_inv_c_;
+  y_hat_.noalias() += ct_r_inv_ * y;
+  return true;
+}
+
+Eigen::VectorXd InformationFilter::State() const {
+  return Y_.llt().solve(y_hat_);
+}
+
+Eigen::MatrixXd InformationFilter::EstimateErrorCovariance() const {
+  return Y_.llt().solve(I_);
+}
+
+}  // namespace slam_dunk
@@ -0,0 +1,74 @@
+// Kalman filter in information form.
+#ifndef SLAM_DUNK_KALMAN_FILTER_INFORMATION_FILTER_H_
+#define SLAM_DUNK_KALMAN_FILTER_INFORMATION_FILTER_H_
+#include <cstdint>
+#include <Eigen/Eigen>
+
+namespace slam_dunk {
+
+// Tracks the information matrix Y = P^-1 and the information vector
+// y_hat = Y x_hat instead of P and x_hat. Measurements then contribute
+// C^T R^-1 C and C^T R^-1 y, which simply add up: fusing m sensors costs
+// O(m n) with no m x m inversion, and sensors can be fused in any order or
+// in separate calls. The price is two n x n inversions per prediction,
+// which is cheap while there are far fewer states than measurements.
+class InformationFilter {
+ public:
+  // Same matrices as KalmanFilter.
+  InformationFilter(double dt, const Eigen::MatrixXd& A,
+                    const Eigen::MatrixXd& C, const Eigen::MatrixXd& Q,
+                    const Eigen::MatrixXd& R, const Eigen::MatrixXd& P);
+
+  // Initialize the filter with initial states as zero.
+  void Init();
+
+  // Initialize the filter with a guess for initial states.
+  void Init(double t0, const Eigen::VectorXd& x0);
+
+  // Predict one time step and fuse the measurements `y` of the sensors
+  // given by C and R. Returns true of successful.
+  bool Update(const Eigen::VectorXd& y);
+
+  // Propagate the estimate by one time step, without measurements.
+  bool Predict();
+
+  // Add measurements `y` from other sensors to the current step.
+  bool Fuse(const Eigen::MatrixXd& C, const Eigen::MatrixXd& R,
+            const Eigen::VectorXd& y);
+
+  // Return the current state and time.
+  Eigen::VectorXd State() const;
+  double Time() const { return t_; }
+
+  Eigen::MatrixXd EstimateErrorCovariance() const;
+  Eigen::MatrixXd InformationMatrix() const { return Y_; }
+  void SetMeasurementNoiseCovariance(const Eigen::MatrixXd& noise);
+
+ private:
+  Eigen::MatrixXd A_;
+  Eigen::MatrixXd C_;
+  Eigen::MatrixXd Q_;
+  Eigen::MatrixXd P0_;
+
+  // C^T R^-1 and C^T R^-1 C of the sensors fused by Update.
+  Eigen::MatrixXd ct_r_inv_;
+  Eigen::MatrixXd ct_r_inv_c_;
+
+  int32_t n_;
+  double dt_;
+  Eigen::MatrixXd I_;
+  bool initialized_ = false;
+  double t_ = 0;
+
+  // Information matrix and vector.
+  Eigen::MatrixXd Y_;
+  Eigen::VectorXd y_hat_;
+
+  // Scratch for Predict.
+  Eigen::MatrixXd P_;
+  Eigen::VectorXd x_;
+};
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_KALMAN_FILTER_INFORMATION_FILTER_H_
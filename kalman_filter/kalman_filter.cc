@@ -16,7 +16,8 @@ KalmanFilter::KalmanFilter(double dt, const Eigen::MatrixXd& A,
       I_(n_, n_),
       initialized_(false),
       x_hat_(n_),
-      x_hat_new_(n_) {
+      x_hat_new_(n_),
+      pct_(n_) {
   I_.setIdentity();
 }
 
@@ -36,11 +37,15 @@ void KalmanFilter::Init() {
   initialized_ = true;
 }
 
+void KalmanFilter::Predict() {
+  x_hat_new_ = A_ * x_hat_;
+  P_ = A_ * P_ * A_.transpose() + Q_;
+}
+
 bool KalmanFilter::Update(const Eigen::VectorXd& y) {
   if (!initialized_) return false;
 
-  x_hat_new_ = A_ * x_hat_;
-  P_ = A_ * P_ * A_.transpose() + Q_;
+  Predict();
   K_ = P_ * C_.transpose() * (C_ * P_ * C_.transpose() + R_).inverse();
   x_hat_new_ += K_ * (y - C_ * x_hat_new_);
   P_ = (I_ - K_ * C_) * P_;
@@ -50,6 +55,24 @@ bool KalmanFilter::Update(const Eigen::VectorXd& y) {
   return true;
 }
 
+bool KalmanFilter::UpdateSequential(const Eigen::VectorXd& y) {
+  if (!initialized_) return false;
+
+  Predict();
+  for (int32_t i = 0; i < m_; ++i) {
+    // Scalar innovation variance s = C_i P C_i^T + R_ii, gain P C_i^T / s.
+    pct_.noalias() = P_ * C_.row(i).transpose();
+    const double s = C_.row(i).dot(pct_) + R_(i, i);
+    const double innovation = y(i) - C_.row(i).dot(x_hat_new_);
+    x_hat_new_ += pct_ * (innovation / s);
+    P_.noalias() -= pct_ * (pct_.transpose() / s);
+  }
+  x_hat_ = x_hat_new_;
+
+  t_ += dt_;
+  return true;
+}
+
 bool KalmanFilter::Update(const Eigen::VectorXd& y, double dt,
                           const Eigen::MatrixXd A) {
   A_ = A;
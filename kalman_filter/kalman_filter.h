@@ -41,6 +41,12 @@ class KalmanFilter {
   // Returns true of successful.
   bool Update(const Eigen::VectorXd& y, double dt, const Eigen::MatrixXd A);
 
+  // Same as Update, but folds the measurements in one at a time, which
+  // needs no matrix inversion. Only valid for uncorrelated measurements:
+  // the off-diagonal terms of R are ignored. Many sensors per step are
+  // much cheaper this way, O(m n^2) instead of O(m^3).
+  bool UpdateSequential(const Eigen::VectorXd& y);
+
   // Return the current state and time.
   Eigen::VectorXd State() const { return x_hat_; };
   double Time() const { return t_; };
@@ -51,6 +57,9 @@ class KalmanFilter {
   }
 
  private:
+  // Propagate the state and its covariance by one time step.
+  void Predict();
+
   // Matrices for computation
   Eigen::MatrixXd A_;
   Eigen::MatrixXd C_;
@@ -80,6 +89,9 @@ class KalmanFilter {
   // Estimated states
   Eigen::VectorXd x_hat_;
   Eigen::VectorXd x_hat_new_;
+
+  // P C_i^T of the measurement being folded in by UpdateSequential.
+  Eigen::VectorXd pct_;
 };
 
 }  // namespace slam_dunk
@@ -0,0 +1,86 @@
+// One filter step with m uncorrelated position sensors on a 3-state
+// projectile: batch Update, UpdateSequential and the information filter.
+// blaze run -c opt //kalman_filter:kalman_filter_benchmark
+#include <array>
+#include <random>
+#include <Eigen/Eigen>
+#include <benchmark/benchmark.h>
+#include "kalman_filter/information_filter.h"
+#include "kalman_filter/kalman_filter.h"
+
+namespace slam_dunk {
+namespace {
+
+constexpr int kStates = 3;
+constexpr double kDt = 1.0 / 30;
+
+struct Model {
+  explicit Model(int m)
+      : A(kStates, kStates),
+        C(m, kStates),
+        Q(kStates, kStates),
+        R(Eigen::MatrixXd::Zero(m, m)),
+        P(kStates, kStates) {
+    A << 1, kDt, 0, 0, 1, kDt, 0, 0, 1;
+    C.setZero();
+    C.col(0).setOnes();
+    Q << .05, .05, .0, .05, .05, .0, .0, .0, .0;
+    for (int i = 0; i < m; ++i) R(i, i) = 5 * (1 + i % 4);
+    P << .1, .1, .1, .1, 10000, 10, .1, 10, 100;
+    x0 << 1, 0, -9.81;
+    std::mt19937 random(1);
+    std::normal_distribution<double> noise(0, 1);
+    for (Eigen::VectorXd& y : measurements) {
+      y.resize(m);
+      for (int i = 0; i < m; ++i) y(i) = 1 + noise(random);
+    }
+  }
+
+  Eigen::MatrixXd A, C, Q, R, P;
+  Eigen::Vector3d x0;
+  std::array<Eigen::VectorXd, 64> measurements;
+};
+
+template <typename Filter, typename Step>
+void Run(benchmark::State& state, Step step) {
+  const Model model(state.range(0));
+  Filter filter(kDt, model.A, model.C, model.Q, model.R, model.P);
+  filter.Init(0, model.x0);
+  size_t i = 0;
+  for (auto _ : state) {
+    // Restart now and then so that P doesn't converge to a fixed point.
+    if (++i == model.measurements.size()) {
+      i = 0;
+      filter.Init(0, model.x0);
+    }
+    benchmark::DoNotOptimize(step(filter, model.measurements[i]));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_Update(benchmark::State& state) {
+  Run<KalmanFilter>(state, [](KalmanFilter& filter, const Eigen::VectorXd& y) {
+    return filter.Update(y);
+  });
+}
+BENCHMARK(BM_Update)->RangeMultiplier(2)->Range(1, 64);
+
+void BM_UpdateSequential(benchmark::State& state) {
+  Run<KalmanFilter>(state, [](KalmanFilter& filter, const Eigen::VectorXd& y) {
+    return filter.UpdateSequential(y);
+  });
+}
+BENCHMARK(BM_UpdateSequential)->RangeMultiplier(2)->Range(1, 64);
+
+void BM_InformationFilter(benchmark::State& state) {
+  Run<InformationFilter>(
+      state, [](InformationFilter& filter, const Eigen::VectorXd& y) {
+        return filter.Update(y);
+      });
+}
+BENCHMARK(BM_InformationFilter)->RangeMultiplier(2)->Range(1, 64);
+
+}  // namespace
+}  // namespace slam_dunk
+
+BENCHMARK_MAIN();
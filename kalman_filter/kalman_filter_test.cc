@@ -1,9 +1,14 @@
-#include "kalman_filter.h"
+#include "kalman_filter/kalman_filter.h"
+#include <cmath>
+#include <random>
+#include <tuple>
+#include <vector>
 #include <Eigen/Eigen>
 #include "absl/strings/str_format.h"
 #include "glog/logging.h"
 #include "gmock/gmock-matchers.h"
 #include "gtest/gtest.h"
+#include "kalman_filter/information_filter.h"
 
 namespace slam_dunk {
 namespace {
@@ -73,5 +78,133 @@ TEST(KalmanFilter, BasicWorks) {
   EXPECT_THAT(kf.State().transpose()[2], DoubleNear(-9.2, kMaxAbsError));
 }
 
+// A simulated projectile like the one of BasicWorks, measured by `m` position
+// sensors of different quality.
+struct Projectile {
+  explicit Projectile(int m) : A(3, 3), C(m, 3), Q(3, 3), R(m, m), P(3, 3) {
+    A << 1, dt, 0, 0, 1, dt, 0, 0, 1;
+    C.setZero();
+    C.col(0).setOnes();
+    Q << .05, .05, .0, .05, .05, .0, .0, .0, .0;
+    R.setZero();
+    for (int i = 0; i < m; ++i) R(i, i) = 5 * (1 + i % 4);
+    P << .1, .1, .1, .1, 10000, 10, .1, 10, 100;
+    x0 << Height(0), 0, -9.81;
+  }
+
+  // True height at `step`, thrown upwards at 3 m/s from 1 m.
+  static double Height(size_t step) {
+    const double t = step * dt;
+    return 1 + 3 * t - 9.81 / 2 * t * t;
+  }
+
+  // Each sensor sees the true height plus its own noise.
+  Eigen::VectorXd Measure(size_t step) const {
+    std::mt19937 random(step);
+    Eigen::VectorXd y(C.rows());
+    for (int i = 0; i < y.size(); ++i) {
+      std::normal_distribution<double> noise(0, std::sqrt(R(i, i)) / 10);
+      y(i) = Height(step) + noise(random);
+    }
+    return y;
+  }
+
+  auto Matrices() const { return std::tie(A, C, Q, R, P); }
+
+  static constexpr double dt = 1.0 / 30;
+  static constexpr size_t kSteps = 45;
+  Eigen::MatrixXd A, C, Q, R, P;
+  Eigen::Vector3d x0;
+};
+
+class KalmanFilterVariants : public ::testing::TestWithParam<int> {};
+
+TEST_P(KalmanFilterVariants, SequentialMatchesUpdate) {
+  const Projectile projectile(GetParam());
+  const auto& [A, C, Q, R, P] = projectile.Matrices();
+  KalmanFilter batch(projectile.dt, A, C, Q, R, P);
+  KalmanFilter sequential(projectile.dt, A, C, Q, R, P);
+  batch.Init(0, projectile.x0);
+  sequential.Init(0, projectile.x0);
+
+  for (size_t i = 0; i < Projectile::kSteps; ++i) {
+    const Eigen::VectorXd y = projectile.Measure(i);
+    ASSERT_TRUE(batch.Update(y));
+    ASSERT_TRUE(sequential.UpdateSequential(y));
+    ASSERT_TRUE(sequential.State().isApprox(batch.State(), 1e-9))
+        << "step " << i << ": " << sequential.State().transpose() << " vs "
+        << batch.State().transpose();
+  }
+  EXPECT_TRUE(sequential.EstimateErrorCovariance().isApprox(
+      batch.EstimateErrorCovariance(), 1e-9));
+  EXPECT_DOUBLE_EQ(sequential.Time(), batch.Time());
+}
+
+TEST_P(KalmanFilterVariants, InformationFilterMatchesUpdate) {
+  const Projectile projectile(GetParam());
+  const auto& [A, C, Q, R, P] = projectile.Matrices();
+  KalmanFilter batch(projectile.dt, A, C, Q, R, P);
+  InformationFilter information(projectile.dt, A, C, Q, R, P);
+  batch.Init(0, projectile.x0);
+  information.Init(0, projectile.x0);
+
+  for (size_t i = 0; i < Projectile::kSteps; ++i) {
+    const Eigen::VectorXd y = projectile.Measure(i);
+    ASSERT_TRUE(batch.Update(y));
+    ASSERT_TRUE(information.Update(y));
+    ASSERT_TRUE(information.State().isApprox(batch.State(), 1e-6))
+        << "step " << i << ": " << information.State().transpose() << " vs "
+        << batch.State().transpose();
+  }
+  EXPECT_TRUE(information.EstimateErrorCovariance().isApprox(
+      batch.EstimateErrorCovariance(), 1e-6));
+}
+
+INSTANTIATE_TEST_SUITE_P(Sensors, KalmanFilterVariants,
+                         ::testing::Values(1, 2, 16, 64));
+
+TEST(KalmanFilter, SequentialBasicWorks) {
+  const Projectile projectile(1);
+  KalmanFilter kf(projectile.dt, projectile.A, projectile.C, projectile.Q,
+                  projectile.R, projectile.P);
+  kf.Init(0, projectile.x0);
+  for (size_t i = 0; i < Projectile::kSteps; ++i) {
+    ASSERT_TRUE(kf.UpdateSequential(projectile.Measure(i)));
+  }
+  EXPECT_THAT(kf.State()[2], DoubleNear(-9.81, kMaxAbsError));
+}
+
+TEST(InformationFilter, FusingSensorsSeparatelyIsAdditive) {
+  const Projectile projectile(8);
+  InformationFilter all(projectile.dt, projectile.A, projectile.C,
+                        projectile.Q, projectile.R, projectile.P);
+  // No sensors of its own, they are fused in two halves below.
+  InformationFilter halves(projectile.dt, projectile.A,
+                           Eigen::MatrixXd::Zero(1, 3), projectile.Q,
+                           Eigen::MatrixXd::Identity(1, 1), projectile.P);
+  all.Init(0, projectile.x0);
+  halves.Init(0, projectile.x0);
+
+  for (size_t i = 0; i < Projectile::kSteps; ++i) {
+    const Eigen::VectorXd y = projectile.Measure(i);
+    ASSERT_TRUE(all.Update(y));
+    ASSERT_TRUE(halves.Predict());
+    ASSERT_TRUE(halves.Fuse(projectile.C.bottomRows(4),
+                            projectile.R.bottomRightCorner(4, 4),
+                            y.tail(4)));
+    ASSERT_TRUE(halves.Fuse(projectile.C.topRows(4),
+                            projectile.R.topLeftCorner(4, 4), y.head(4)));
+  }
+  EXPECT_TRUE(halves.State().isApprox(all.State(), 1e-9));
+  EXPECT_THAT(all.State()[2], DoubleNear(-9.81, kMaxAbsError));
+}
+
+TEST(InformationFilter, NotInitialized) {
+  const Projectile projectile(1);
+  InformationFilter filter(projectile.dt, projectile.A, projectile.C,
+                           projectile.Q, projectile.R, projectile.P);
+  EXPECT_FALSE(filter.Update(Eigen::VectorXd::Zero(1)));
+}
+
 }  // namespace
 }  // namespace slam_dunk
@@ -0,0 +1,229 @@
+#include "kalman_filter/rts_smoother.h"
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <utility>
+#include "absl/memory/memory.h"
+#include "absl/strings/str_format.h"
+
+namespace slam_dunk {
+namespace {
+
+// Number of doubles in the upper triangle of an n x n matrix.
+int64_t TriangleSize(int64_t n) { return n * (n + 1) / 2; }
+
+double* PackVector(const Eigen::VectorXd& v, double* out) {
+  for (Eigen::Index i = 0; i < v.size(); ++i) *out++ = v(i);
+  return out;
+}
+
+double* PackSymmetric(const Eigen::MatrixXd& m, double* out) {
+  for (Eigen::Index c = 0; c < m.cols(); ++c) {
+    for (Eigen::Index r = 0; r <= c; ++r) *out++ = m(r, c);
+  }
+  return out;
+}
+
+const double* UnpackVector(const double* in, Eigen::VectorXd& v) {
+  for (Eigen::Index i = 0; i < v.size(); ++i) v(i) = *in++;
+  return in;
+}
+
+const double* UnpackSymmetric(const double* in, Eigen::MatrixXd& m) {
+  for (Eigen::Index c = 0; c < m.cols(); ++c) {
+    for (Eigen::Index r = 0; r <= c; ++r) m(r, c) = m(c, r) = *in++;
+  }
+  return in;
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<RtsSmoother>> RtsSmoother::Create(
+    const Eigen::MatrixXd& A, const Eigen::MatrixXd& Q,
+    const Options& options) {
+  if (A.rows() == 0 || A.rows() != A.cols() || Q.rows() != A.rows() ||
+      Q.cols() != A.cols()) {
+    return absl::InvalidArgumentError(
+        "A and Q must be square matrices of the same size");
+  }
+  if (options.chunk_steps < 2) {
+    return absl::InvalidArgumentError("chunk_steps must be at least 2");
+  }
+  return absl::WrapUnique(new RtsSmoother(A, Q, options));
+}
+
+RtsSmoother::RtsSmoother(const Eigen::MatrixXd& A, const Eigen::MatrixXd& Q,
+                         const Options& options)
+    : A_(A),
+      Q_(Q),
+      options_(options),
+      n_(A.rows()),
+      stride_(2 * (n_ + TriangleSize(n_))),
+      buffer_(options.chunk_steps * stride_),
+      x_(n_),
+      P_(n_, n_),
+      x_filtered_(n_),
+      P_filtered_(n_, n_),
+      x_predicted_(n_),
+      P_predicted_(n_, n_) {}
+
+RtsSmoother::~RtsSmoother() {
+  for (int64_t chunk = 0; chunk < chunks_on_disk_; ++chunk) {
+    std::remove(ChunkPath(chunk).c_str());
+  }
+}
+
+std::string RtsSmoother::ChunkPath(int64_t chunk) const {
+  return absl::StrFormat("%s/rts_%d_%p_%06d.bin", options_.checkpoint_dir,
+                         getpid(), this, chunk);
+}
+
+absl::Status RtsSmoother::WriteChunk(int64_t chunk) {
+  const std::string path = ChunkPath(chunk);
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(buffer_.data()),
+             buffer_.size() * sizeof(double));
+  file.close();
+  if (!file) {
+    // Not counted in chunks_on_disk_, so the destructor would miss it.
+    std::remove(path.c_str());
+    return absl::InternalError(absl::StrFormat("Failed to write %s", path));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RtsSmoother::ReadChunk(int64_t chunk) {
+  const std::string path = ChunkPath(chunk);
+  std::ifstream file(path, std::ios::binary);
+  file.read(reinterpret_cast<char*>(buffer_.data()),
+            buffer_.size() * sizeof(double));
+  if (!file) {
+    return absl::DataLossError(absl::StrFormat("Failed to read %s", path));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RtsSmoother::Record(const KalmanFilter& filter) {
+  return Record(filter.State(), filter.EstimateErrorCovariance());
+}
+
+absl::Status RtsSmoother::Record(const Eigen::VectorXd& x,
+                                 const Eigen::MatrixXd& P) {
+  if (smoothed_) {
+    return absl::FailedPreconditionError("Already smoothed");
+  }
+  if (x.size() != n_ || P.rows() != n_ || P.cols() != n_) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Expected a state of size %d, got %d", n_, x.size()));
+  }
+  if (buffered_ == options_.chunk_steps) {
+    if (options_.checkpoint_dir.empty()) {
+      return absl::ResourceExhaustedError(absl::StrFormat(
+          "More than %d steps and no checkpoint_dir", options_.chunk_steps));
+    }
+    if (auto status = WriteChunk(chunks_on_disk_); !status.ok()) {
+      return status;
+    }
+    ++chunks_on_disk_;
+    buffered_ = 0;
+  }
+
+  // The prediction from the previous step; the first step has none and
+  // the backward pass never needs it.
+  if (size_ == 0) {
+    x_predicted_.setZero();
+    P_predicted_.setZero();
+  } else {
+    x_predicted_.noalias() = A_ * x_;
+    P_predicted_.noalias() = A_ * P_ * A_.transpose();
+    P_predicted_ += Q_;
+  }
+  double* out = buffer_.data() + buffered_ * stride_;
+  out = PackVector(x, out);
+  out = PackSymmetric(P, out);
+  out = PackVector(x_predicted_, out);
+  PackSymmetric(P_predicted_, out);
+
+  x_ = x;
+  P_ = P;
+  ++buffered_;
+  ++size_;
+  return absl::OkStatus();
+}
+
+void RtsSmoother::Unpack(int64_t index) {
+  const double* in = buffer_.data() + index * stride_;
+  in = UnpackVector(in, x_filtered_);
+  in = UnpackSymmetric(in, P_filtered_);
+  in = UnpackVector(in, x_predicted_);
+  UnpackSymmetric(in, P_predicted_);
+}
+
+absl::Status RtsSmoother::Smooth(const Visitor& visitor) {
+  if (smoothed_) {
+    return absl::FailedPreconditionError("Already smoothed");
+  }
+  smoothed_ = true;
+  if (size_ == 0) return absl::OkStatus();
+
+  // The last step has seen every measurement already.
+  int64_t index = buffered_ - 1;
+  Unpack(index);
+  Eigen::VectorXd x_smoothed = x_filtered_;
+  Eigen::MatrixXd P_smoothed = P_filtered_;
+  if (auto status = visitor(size_ - 1, x_smoothed, P_smoothed); !status.ok()) {
+    return status;
+  }
+
+  // Prediction for step k + 1 from step k.
+  Eigen::VectorXd x_next = x_predicted_;
+  Eigen::MatrixXd P_next = P_predicted_;
+  Eigen::MatrixXd gain_transpose(n_, n_);
+  Eigen::LLT<Eigen::MatrixXd> llt(n_);
+  Eigen::VectorXd x_correction(n_);
+  Eigen::MatrixXd P_correction(n_, n_);
+  int64_t chunk = chunks_on_disk_;
+  for (int64_t step = size_ - 2; step >= 0; --step) {
+    if (--index < 0) {
+      if (auto status = ReadChunk(--chunk); !status.ok()) return status;
+      index = options_.chunk_steps - 1;
+    }
+    Unpack(index);
+
+    // G = P_k|k A^T P_k+1|k^-1, computed as its transpose by a solve.
+    llt.compute(P_next);
+    if (llt.info() != Eigen::Success) {
+      return absl::FailedPreconditionError(absl::StrFormat(
+          "Predicted covariance of step %d is not positive definite",
+          step + 1));
+    }
+    gain_transpose.noalias() = A_ * P_filtered_;
+    llt.solveInPlace(gain_transpose);
+    x_smoothed -= x_next;
+    x_correction.noalias() = gain_transpose.transpose() * x_smoothed;
+    x_smoothed = x_filtered_ + x_correction;
+    P_smoothed -= P_next;
+    P_correction.noalias() = P_smoothed * gain_transpose;
+    P_smoothed = P_filtered_;
+    P_smoothed.noalias() += gain_transpose.transpose() * P_correction;
+    if (auto status = visitor(step, x_smoothed, P_smoothed); !status.ok()) {
+      return status;
+    }
+    x_next = x_predicted_;
+    P_next = P_predicted_;
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<Eigen::VectorXd>> RtsSmoother::SmoothedStates() {
+  std::vector<Eigen::VectorXd> states(size_);
+  auto status = Smooth([&states](int64_t step, const Eigen::VectorXd& x,
+                                 const Eigen::MatrixXd&) {
+    states[step] = x;
+    return absl::OkStatus();
+  });
+  if (!status.ok()) return status;
+  return states;
+}
+
+}  // namespace slam_dunk
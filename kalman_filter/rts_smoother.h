@@ -0,0 +1,103 @@
+// Rauch-Tung-Striebel smoother over a recorded Kalman filter forward pass.
+#ifndef SLAM_DUNK_KALMAN_FILTER_RTS_SMOOTHER_H_
+#define SLAM_DUNK_KALMAN_FILTER_RTS_SMOOTHER_H_
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <Eigen/Eigen>
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "kalman_filter/kalman_filter.h"
+
+namespace slam_dunk {
+
+// Records the filtered estimates of a forward pass and runs the backward
+// RTS pass over them, which gives every step the benefit of all
+// measurements, past and future.
+//
+// Each step takes one fixed-size record in a contiguous buffer allocated
+// up front: the filtered state and covariance, and the prediction that led
+// to them. Covariances are symmetric, so only their upper triangles are
+// kept. Runs longer than one chunk of `chunk_steps` spill full chunks to
+// checkpoint files, so memory stays bounded however long the run is; the
+// backward pass reads them back last to first.
+class RtsSmoother {
+ public:
+  struct Options {
+    // Steps kept in memory.
+    int64_t chunk_steps = int64_t{1} << 16;
+    // Where to checkpoint full chunks. If empty, recording more than
+    // chunk_steps steps fails.
+    std::string checkpoint_dir;
+  };
+
+  // Smoothed estimate of one step, visited from the last step to the first.
+  using Visitor = std::function<absl::Status(
+      int64_t step, const Eigen::VectorXd& x, const Eigen::MatrixXd& P)>;
+
+  // A and Q as given to the KalmanFilter, assumed constant over the run.
+  static absl::StatusOr<std::unique_ptr<RtsSmoother>> Create(
+      const Eigen::MatrixXd& A, const Eigen::MatrixXd& Q,
+      const Options& options);
+  // Removes the checkpoint files.
+  ~RtsSmoother();
+
+  // Records the estimate of `filter` after its Update for the next step.
+  absl::Status Record(const KalmanFilter& filter);
+  // Records filtered state `x` and covariance `P` for the next step.
+  absl::Status Record(const Eigen::VectorXd& x, const Eigen::MatrixXd& P);
+
+  // Number of recorded steps.
+  int64_t size() const { return size_; }
+
+  // Runs the backward pass. The recording is consumed: Smooth can run once.
+  // Fails if a predicted covariance is not positive definite, e.g. with
+  // Q = 0 and a singular P.
+  absl::Status Smooth(const Visitor& visitor);
+  // Runs the backward pass and returns the smoothed states in step order.
+  // Needs memory for the whole trajectory.
+  absl::StatusOr<std::vector<Eigen::VectorXd>> SmoothedStates();
+
+  // Not copyable
+  RtsSmoother(const RtsSmoother&) = delete;
+  RtsSmoother& operator=(const RtsSmoother&) = delete;
+
+ private:
+  RtsSmoother(const Eigen::MatrixXd& A, const Eigen::MatrixXd& Q,
+              const Options& options);
+
+  std::string ChunkPath(int64_t chunk) const;
+  absl::Status WriteChunk(int64_t chunk);
+  absl::Status ReadChunk(int64_t chunk);
+  // Copies the record at `index` of the buffer into the scratch members.
+  void Unpack(int64_t index);
+
+  const Eigen::MatrixXd A_;
+  const Eigen::MatrixXd Q_;
+  const Options options_;
+  const int32_t n_;
+  // Doubles in one record: filtered x and P, predicted x and P.
+  const int64_t stride_;
+
+  std::vector<double> buffer_;
+  // Steps in `buffer_`, in files, and in total.
+  int64_t buffered_ = 0;
+  int64_t chunks_on_disk_ = 0;
+  int64_t size_ = 0;
+  bool smoothed_ = false;
+
+  // Last filtered estimate, for the prediction of the next step.
+  Eigen::VectorXd x_;
+  Eigen::MatrixXd P_;
+  // Scratch for records going in and out of the buffer.
+  Eigen::VectorXd x_filtered_;
+  Eigen::MatrixXd P_filtered_;
+  Eigen::VectorXd x_predicted_;
+  Eigen::MatrixXd P_predicted_;
+};
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_KALMAN_FILTER_RTS_SMOOTHER_H_
@@ -0,0 +1,75 @@
+// Forward pass recording and RTS backward pass over a million steps of a
+// 3-state filter, in memory and checkpointed in chunks to disk.
+// blaze run -c opt //kalman_filter:rts_smoother_benchmark
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <Eigen/Eigen>
+#include <benchmark/benchmark.h>
+#include "kalman_filter/kalman_filter.h"
+#include "kalman_filter/rts_smoother.h"
+
+namespace slam_dunk {
+namespace {
+
+constexpr int64_t kSteps = 1'000'000;
+constexpr double kDt = 1.0 / 30;
+
+std::string CheckpointDir() {
+  const char* dir = std::getenv("TEST_TMPDIR");
+  return dir == nullptr ? "/tmp" : dir;
+}
+
+void BM_FilterAndSmooth(benchmark::State& state) {
+  Eigen::MatrixXd A(3, 3), C(1, 3), Q(3, 3), R(1, 1), P(3, 3);
+  A << 1, kDt, 0, 0, 1, kDt, 0, 0, 1;
+  C << 1, 0, 0;
+  Q << .05, .05, .0, .05, .05, .0, .0, .0, .0;
+  R << 5;
+  P << .1, .1, .1, .1, 10000, 10, .1, 10, 100;
+  std::mt19937 random(1);
+  std::normal_distribution<double> noise(0, 1);
+  std::vector<double> measurements(kSteps);
+  for (double& y : measurements) y = noise(random);
+
+  RtsSmoother::Options options;
+  options.chunk_steps = state.range(0);
+  options.checkpoint_dir = CheckpointDir();
+  const bool smooth = state.range(0) > 0;
+  if (!smooth) options.chunk_steps = 2;
+  for (auto _ : state) {
+    auto smoother = RtsSmoother::Create(A, Q, options);
+    KalmanFilter filter(kDt, A, C, Q, R, P);
+    filter.Init();
+    Eigen::VectorXd y(1);
+    for (double measurement : measurements) {
+      y << measurement;
+      filter.Update(y);
+      if (smooth) benchmark::DoNotOptimize((*smoother)->Record(filter));
+    }
+    double sum = 0;
+    benchmark::DoNotOptimize((*smoother)->Smooth(
+        [&sum](int64_t, const Eigen::VectorXd& x, const Eigen::MatrixXd&) {
+          sum += x(0);
+          return absl::OkStatus();
+        }));
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kSteps);
+  // Memory held by the recording buffer.
+  state.counters["buffer_mb"] =
+      state.range(0) * 18 * sizeof(double) / (1024.0 * 1024.0);
+}
+// Forward filter alone for reference, all in memory, then bounded to 64k
+// steps per chunk.
+BENCHMARK(BM_FilterAndSmooth)
+    ->Arg(0)
+    ->Arg(kSteps)
+    ->Arg(int64_t{1} << 16)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace slam_dunk
+
+BENCHMARK_MAIN();
@@ -0,0 +1,198 @@
+#include "kalman_filter/rts_smoother.h"
+#include <cmath>
+#include <filesystem>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+#include <Eigen/Eigen>
+#include "absl/status/status_matchers.h"
+#include "gtest/gtest.h"
+#include "kalman_filter/kalman_filter.h"
+
+namespace slam_dunk {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+
+constexpr double kDt = 0.1;
+
+// A robot moving at constant velocity with a noisy position sensor.
+struct Recording {
+  explicit Recording(int steps) : A(2, 2), C(1, 2), Q(2, 2), R(1, 1), P(2, 2) {
+    A << 1, kDt, 0, 1;
+    C << 1, 0;
+    Q << 1e-4, 0, 0, 1e-3;
+    R << 0.25;
+    P << 1, 0, 0, 1;
+    std::mt19937 random(42);
+    std::normal_distribution<double> noise(0, 0.5);
+    std::normal_distribution<double> jitter(0, 0.03);
+    Eigen::Vector2d x(0, 1);
+    for (int i = 0; i < steps; ++i) {
+      x = A * x;
+      x(1) += jitter(random);
+      truth.push_back(x);
+      measurements.push_back(x(0) + noise(random));
+    }
+  }
+
+  Eigen::MatrixXd A, C, Q, R, P;
+  std::vector<Eigen::VectorXd> truth;
+  std::vector<double> measurements;
+};
+
+// Filters the run, recording into `smoother`; returns the filtered states.
+std::vector<Eigen::VectorXd> Filter(const Recording& run,
+                                    RtsSmoother& smoother) {
+  KalmanFilter filter(kDt, run.A, run.C, run.Q, run.R, run.P);
+  filter.Init();
+  std::vector<Eigen::VectorXd> filtered;
+  Eigen::VectorXd y(1);
+  for (double measurement : run.measurements) {
+    y << measurement;
+    filter.Update(y);
+    EXPECT_THAT(smoother.Record(filter), IsOk());
+    filtered.push_back(filter.State());
+  }
+  return filtered;
+}
+
+double RmsError(const std::vector<Eigen::VectorXd>& estimates,
+                const std::vector<Eigen::VectorXd>& truth) {
+  double sum = 0;
+  for (size_t i = 0; i < truth.size(); ++i) {
+    sum += (estimates[i] - truth[i]).squaredNorm();
+  }
+  return std::sqrt(sum / truth.size());
+}
+
+TEST(RtsSmoother, SmoothingBeatsFiltering) {
+  const Recording run(500);
+  auto smoother = RtsSmoother::Create(run.A, run.Q, {});
+  ASSERT_THAT(smoother, IsOk());
+  const std::vector<Eigen::VectorXd> filtered = Filter(run, **smoother);
+  EXPECT_EQ((*smoother)->size(), 500);
+
+  auto smoothed = (*smoother)->SmoothedStates();
+  ASSERT_THAT(smoothed, IsOk());
+  ASSERT_EQ(smoothed->size(), 500);
+  // The last step has no future measurements to learn from.
+  EXPECT_TRUE(smoothed->back().isApprox(filtered.back()));
+  EXPECT_LT(RmsError(*smoothed, run.truth),
+            0.7 * RmsError(filtered, run.truth));
+}
+
+TEST(RtsSmoother, SmoothedCovarianceIsSmaller) {
+  const Recording run(100);
+  auto smoother = RtsSmoother::Create(run.A, run.Q, {});
+  ASSERT_THAT(smoother, IsOk());
+  KalmanFilter filter(kDt, run.A, run.C, run.Q, run.R, run.P);
+  filter.Init();
+  std::vector<Eigen::MatrixXd> filtered;
+  Eigen::VectorXd y(1);
+  for (double measurement : run.measurements) {
+    y << measurement;
+    filter.Update(y);
+    ASSERT_THAT((*smoother)->Record(filter), IsOk());
+    filtered.push_back(filter.EstimateErrorCovariance());
+  }
+  int64_t visited = 0;
+  ASSERT_THAT((*smoother)->Smooth([&](int64_t step, const Eigen::VectorXd&,
+                                      const Eigen::MatrixXd& P) {
+    EXPECT_EQ(step, 99 - visited++);
+    EXPECT_LE(P.trace(), filtered[step].trace() + 1e-12) << "step " << step;
+    return absl::OkStatus();
+  }),
+              IsOk());
+  EXPECT_EQ(visited, 100);
+}
+
+TEST(RtsSmoother, CheckpointedChunksMatchInMemory) {
+  const Recording run(1000);
+  auto in_memory = RtsSmoother::Create(run.A, run.Q, {.chunk_steps = 1000});
+  ASSERT_THAT(in_memory, IsOk());
+  Filter(run, **in_memory);
+  auto expected = (*in_memory)->SmoothedStates();
+  ASSERT_THAT(expected, IsOk());
+
+  const std::string dir = ::testing::TempDir();
+  // 1000 is not a multiple of the chunk, so the last one is partial.
+  auto chunked = RtsSmoother::Create(
+      run.A, run.Q, {.chunk_steps = 64, .checkpoint_dir = dir});
+  ASSERT_THAT(chunked, IsOk());
+  Filter(run, **chunked);
+  auto smoothed = (*chunked)->SmoothedStates();
+  ASSERT_THAT(smoothed, IsOk());
+  for (size_t i = 0; i < expected->size(); ++i) {
+    ASSERT_EQ((*smoothed)[i], (*expected)[i]) << "step " << i;
+  }
+
+  const auto files = [&dir] {
+    return std::distance(std::filesystem::directory_iterator(dir),
+                         std::filesystem::directory_iterator());
+  };
+  const auto before = files();
+  chunked->reset();
+  EXPECT_EQ(files(), before - 15);
+}
+
+TEST(RtsSmoother, NeedsCheckpointDirBeyondOneChunk) {
+  auto smoother = RtsSmoother::Create(Eigen::MatrixXd::Identity(2, 2),
+                                      Eigen::MatrixXd::Zero(2, 2),
+                                      {.chunk_steps = 2});
+  ASSERT_THAT(smoother, IsOk());
+  const Eigen::VectorXd x = Eigen::VectorXd::Zero(2);
+  const Eigen::MatrixXd P = Eigen::MatrixXd::Identity(2, 2);
+  ASSERT_THAT((*smoother)->Record(x, P), IsOk());
+  ASSERT_THAT((*smoother)->Record(x, P), IsOk());
+  EXPECT_THAT((*smoother)->Record(x, P),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+}
+
+TEST(RtsSmoother, RejectsSingularPrediction) {
+  auto smoother = RtsSmoother::Create(Eigen::MatrixXd::Identity(2, 2),
+                                      Eigen::MatrixXd::Zero(2, 2), {});
+  ASSERT_THAT(smoother, IsOk());
+  const Eigen::VectorXd x = Eigen::VectorXd::Zero(2);
+  const Eigen::MatrixXd P = Eigen::Vector2d(1, 0).asDiagonal();
+  ASSERT_THAT((*smoother)->Record(x, P), IsOk());
+  ASSERT_THAT((*smoother)->Record(x, P), IsOk());
+  EXPECT_THAT((*smoother)->SmoothedStates(),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST(RtsSmoother, FailedCheckpointIsReported) {
+  auto smoother = RtsSmoother::Create(
+      Eigen::MatrixXd::Identity(1, 1), Eigen::MatrixXd::Identity(1, 1),
+      {.chunk_steps = 2, .checkpoint_dir = "/nonexistent"});
+  ASSERT_THAT(smoother, IsOk());
+  const Eigen::VectorXd x = Eigen::VectorXd::Zero(1);
+  const Eigen::MatrixXd P = Eigen::MatrixXd::Identity(1, 1);
+  ASSERT_THAT((*smoother)->Record(x, P), IsOk());
+  ASSERT_THAT((*smoother)->Record(x, P), IsOk());
+  EXPECT_THAT((*smoother)->Record(x, P),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
+TEST(RtsSmoother, SmoothsOnce) {
+  auto smoother = RtsSmoother::Create(Eigen::MatrixXd::Identity(1, 1),
+                                      Eigen::MatrixXd::Identity(1, 1), {});
+  ASSERT_THAT(smoother, IsOk());
+  ASSERT_THAT((*smoother)->SmoothedStates(), IsOk());
+  EXPECT_THAT((*smoother)->SmoothedStates(),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  EXPECT_THAT((*smoother)->Record(Eigen::VectorXd::Zero(1),
+                                  Eigen::MatrixXd::Zero(1, 1)),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST(RtsSmoother, RejectsMismatchedModel) {
+  EXPECT_THAT(RtsSmoother::Create(Eigen::MatrixXd::Identity(2, 2),
+                                  Eigen::MatrixXd::Identity(3, 3), {}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace slam_dunk
@@ -1,22 +1,21 @@
 #include "lidar.h"
 #include <algorithm>
+#include <utility>
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 
 namespace slam_dunk {
 
-Lidar::Lidar(std::unique_ptr<sl::ILidarDriver> driver,
-             std::unique_ptr<sl::IChannel> channel,
-             const sl_lidar_response_device_info_t device_info)
+Lidar::Lidar(std::unique_ptr<LidarDriver> driver,
+             const sl_lidar_response_device_info_t device_info,
+             uint16_t scan_mode)
     : driver_(std::move(driver)),
-      channel_(std::move(channel)),
-      device_info_(device_info) {}
+      device_info_(device_info),
+      scan_mode_(scan_mode),
+      scan_start_(absl::Now()) {}
 
-Lidar::~Lidar() {
-  driver_->stop();
-  driver_->disconnect();
-}
+Lidar::~Lidar() { driver_->Stop(); }
 
 DeviceInfo Lidar::GetDeviceInfo() const {
   DeviceInfo device_info;
@@ -25,58 +24,57 @@ DeviceInfo Lidar::GetDeviceInfo() const {
                       device_info_.firmware_version & 0xFF);
   device_info.hardware = absl::StrCat(device_info_.hardware_version);
   device_info.model = absl::StrCat(device_info_.model);
-  for (uint8_t n : device_info_.serialnum) {
-    device_info.serial_number += absl::StrFormat("%02X", n);
-  }
+  device_info.serial_number = FormatSerialNumber(device_info_);
   return device_info;
 }
 
 absl::StatusOr<std::unique_ptr<Lidar>> Lidar::Create(absl::string_view usb_port,
                                                      int32_t baud_rate) {
-  auto driver_result = sl::createLidarDriver();
-  if (!driver_result)
-    return absl::InternalError("Failed in sl::createLidarDriver()");
-  std::unique_ptr<sl::ILidarDriver> driver =
-      absl::WrapUnique(driver_result.value);
+  auto driver = OpenSerialDriver(usb_port, baud_rate);
+  if (!driver.ok()) return driver.status();
+  return Create(*std::move(driver));
+}
 
-  auto channel_status = sl::createSerialPortChannel(usb_port.data(), baud_rate);
-  if (!channel_status)
-    return absl::InternalError("Failed in sl::createSerialPortChannel");
-  std::unique_ptr<sl::IChannel> channel =
-      absl::WrapUnique(channel_status.value);
+absl::StatusOr<std::unique_ptr<Lidar>> Lidar::Create(
+    std::unique_ptr<LidarDriver> driver, std::optional<uint16_t> scan_mode) {
+  auto device_info = driver->GetDeviceInfo(absl::Seconds(1));
+  if (!device_info.ok()) return device_info.status();
 
-  sl_result status = SL_RESULT_OK;
-  status = driver->connect(channel.get());
-  if (SL_IS_FAIL(status)) {
-    return absl::InternalError(
-        absl::StrFormat("Failed to connect: 0%x", status));
+  if (!scan_mode.has_value()) {
+    auto scan_modes = driver->GetScanModes();
+    if (!scan_modes.ok()) return scan_modes.status();
+    const ScanMode* fastest = FastestScanMode(*scan_modes);
+    if (fastest == nullptr) {
+      return absl::InternalError("No supported scan modes.");
+    }
+    scan_mode = fastest->id;
   }
-  sl_lidar_response_device_info_t device_info;
-  status = driver->getDeviceInfo(device_info);
-  if (SL_IS_FAIL(status)) {
-    return absl::InternalError(
-        absl::StrFormat("Failed to getDeviceInfo: 0%x", status));
+  if (auto status = driver->StartScan(*scan_mode); !status.ok()) {
+    return status;
   }
 
-  std::vector<sl::LidarScanMode> scan_modes;
-  driver->getAllSupportedScanModes(scan_modes);
-  if (scan_modes.empty()) {
-    return absl::InternalError("No supported scan modes.");
-  }
-  driver->startScan(/*force=*/false, scan_modes[0].id);
-
   return absl::WrapUnique(
-      new Lidar(std::move(driver), std::move(channel), device_info));
+      new Lidar(std::move(driver), *device_info, *scan_mode));
 }
 
 absl::StatusOr<std::vector<ScanResponse>> Lidar::Scan(size_t count) {
-  auto nodes = std::vector<sl_lidar_response_measurement_node_hq_t>(count);
-  sl_result status = driver_->grabScanDataHq(&nodes[0], count);
-  if (SL_IS_FAIL(status)) {
-    return absl::InternalError(
-        absl::StrFormat("Failed to grabScanDataHq: 0%x", status));
+  if (pending_.has_value()) {
+    std::vector<ScanResponse> response = *std::move(pending_);
+    pending_.reset();
+    // The driver stores fewer samples than asked for, so the size tells
+    // nothing about the count.
+    if (pending_count_ == count) return response;
   }
-  auto response = std::vector<ScanResponse>(count);
+  return Grab(count, absl::Seconds(2));
+}
+
+absl::StatusOr<std::vector<ScanResponse>> Lidar::Grab(size_t count,
+                                                      absl::Duration timeout) {
+  auto nodes = std::vector<sl_lidar_response_measurement_node_hq_t>(count);
+  auto status = driver_->GrabScanDataHq(nodes.data(), count, timeout);
+  if (!status.ok()) return status;
+  auto response = std::vector<ScanResponse>();
+  response.reserve(count);
   for (size_t i = 0; i < count; ++i) {
     response.emplace_back(ScanResponse{
         .theta = nodes[i].angle_z_q14,
@@ -89,4 +87,30 @@ absl::StatusOr<std::vector<ScanResponse>> Lidar::Scan(size_t count) {
   return response;
 }
 
-}  // namespace slam_dunk
\ No newline at end of file
+absl::StatusOr<absl::Duration> Lidar::WaitForFirstRevolution(
+    absl::Duration timeout, size_t count) {
+  const absl::Time deadline = absl::Now() + timeout;
+  absl::Status last_error = absl::DeadlineExceededError(
+      "No revolution with returns before the deadline");
+  for (absl::Time now = absl::Now(); now < deadline; now = absl::Now()) {
+    // While the motor spins up the driver times out or hands back
+    // revolutions without a single return.
+    auto scan = Grab(count, std::min(absl::Seconds(2), deadline - now));
+    if (!scan.ok()) {
+      last_error = scan.status();
+      continue;
+    }
+    if (std::any_of(scan->begin(), scan->end(), [](const ScanResponse& r) {
+          return r.distance_mm != 0;
+        })) {
+      pending_ = *std::move(scan);
+      pending_count_ = count;
+      return absl::Now() - scan_start_;
+    }
+  }
+  return absl::DeadlineExceededError(absl::StrCat(
+      "No revolution within ", absl::FormatDuration(timeout), ": ",
+      last_error.message()));
+}
+
+}  // namespace slam_dunk
@@ -1,8 +1,13 @@
 #ifndef SLAM_DUNK__LIDAR_H_
 #define SLAM_DUNK__LIDAR_H_
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "lidar_driver.h"
 #include "third_party/rplidar/include/sl_lidar_driver.h"
 
 namespace slam_dunk {
@@ -48,28 +53,51 @@ struct DeviceInfo {
 // Aggregation of Slamtec RPLidar.
 class Lidar {
  public:
-  // Creates lidar with given parameters
+  // Creates lidar with given parameters and starts scanning in the mode
+  // with the highest sample rate.
   static absl::StatusOr<std::unique_ptr<Lidar>> Create(
       absl::string_view usb_port, int32_t baud_rate);
+  // Starts scanning with a connected driver, in `scan_mode` or, if not
+  // given, in the mode with the highest sample rate.
+  static absl::StatusOr<std::unique_ptr<Lidar>> Create(
+      std::unique_ptr<LidarDriver> driver,
+      std::optional<uint16_t> scan_mode = std::nullopt);
   ~Lidar();
 
   // Returns response for the given number of node (points)
   absl::StatusOr<std::vector<ScanResponse>>Scan(size_t count = 8192);
 
+  // Blocks until the motor is up to speed and the first revolution with
+  // returns arrives, and returns the time since scanning started. That
+  // revolution is returned by the next Scan() if it asks for the same
+  // `count`, even though a revolution usually holds fewer samples; a
+  // different count discards it and grabs a new one.
+  absl::StatusOr<absl::Duration> WaitForFirstRevolution(
+      absl::Duration timeout = absl::Seconds(5), size_t count = 8192);
+
   // Returns information about initiated lidar.
   DeviceInfo GetDeviceInfo() const;
 
+  // Id of the scan mode in use.
+  uint16_t scan_mode() const { return scan_mode_; }
+
   // Not copyable
   Lidar(const Lidar&) = delete;
   Lidar& operator=(const Lidar&) = delete;
 
  private:
-  Lidar(std::unique_ptr<sl::ILidarDriver> driver,
-        std::unique_ptr<sl::IChannel> channel,
-        const sl_lidar_response_device_info_t device_info);
-  std::unique_ptr<sl::ILidarDriver> driver_;
-  std::unique_ptr<sl::IChannel> channel_;
+  Lidar(std::unique_ptr<LidarDriver> driver,
+        const sl_lidar_response_device_info_t device_info, uint16_t scan_mode);
+  absl::StatusOr<std::vector<ScanResponse>> Grab(size_t count,
+                                                 absl::Duration timeout);
+  std::unique_ptr<LidarDriver> driver_;
   sl_lidar_response_device_info_t device_info_;
+  uint16_t scan_mode_;
+  absl::Time scan_start_;
+  // Revolution grabbed by WaitForFirstRevolution, not yet returned by Scan,
+  // and the count it was grabbed with.
+  std::optional<std::vector<ScanResponse>> pending_;
+  size_t pending_count_ = 0;
 };
 
 }  // namespace slam_dunk
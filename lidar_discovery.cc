@@ -0,0 +1,230 @@
+#include "lidar_discovery.h"
+#include <glob.h>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "glog/logging.h"
+
+namespace slam_dunk {
+
+absl::StatusOr<std::vector<LidarConfig>> LoadLidarConfigCache(
+    absl::string_view path) {
+  std::ifstream file{std::string(path)};
+  std::vector<LidarConfig> configs;
+  if (!file.is_open()) return configs;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::vector<absl::string_view> fields =
+        absl::StrSplit(line, ' ', absl::SkipEmpty());
+    if (fields.empty()) continue;
+    LidarConfig config;
+    uint32_t scan_mode = 0;
+    if (fields.size() != 4 || !absl::SimpleAtoi(fields[2], &config.baud_rate) ||
+        !absl::SimpleAtoi(fields[3], &scan_mode) || scan_mode > UINT16_MAX) {
+      return absl::DataLossError(
+          absl::StrFormat("Malformed line in %s: %s", path, line));
+    }
+    config.serial_number = std::string(fields[0]);
+    config.usb_port = std::string(fields[1]);
+    config.scan_mode = static_cast<uint16_t>(scan_mode);
+    configs.push_back(std::move(config));
+  }
+  return configs;
+}
+
+absl::Status SaveLidarConfigCache(absl::string_view path,
+                                  const std::vector<LidarConfig>& configs) {
+  std::ofstream file{std::string(path)};
+  if (!file.is_open()) {
+    return absl::InternalError(absl::StrFormat("Cannot write %s", path));
+  }
+  for (const LidarConfig& config : configs) {
+    file << absl::StreamFormat("%s %s %d %d\n", config.serial_number,
+                               config.usb_port, config.baud_rate,
+                               config.scan_mode);
+  }
+  file.close();
+  if (!file) {
+    return absl::InternalError(absl::StrFormat("Failed writing %s", path));
+  }
+  return absl::OkStatus();
+}
+
+LidarDiscovery::LidarDiscovery(const Options& options, DriverFactory factory)
+    : options_(options), factory_(std::move(factory)) {}
+
+LidarDiscovery::~LidarDiscovery() { JoinProbes(); }
+
+absl::StatusOr<std::vector<std::string>> LidarDiscovery::CandidatePorts()
+    const {
+  std::vector<std::string> ports;
+  for (const std::string& pattern : options_.port_patterns) {
+    glob_t matches;
+    if (glob(pattern.c_str(), 0, nullptr, &matches) == 0) {
+      ports.insert(ports.end(), matches.gl_pathv,
+                   matches.gl_pathv + matches.gl_pathc);
+    }
+    globfree(&matches);
+  }
+  std::sort(ports.begin(), ports.end());
+  ports.erase(std::unique(ports.begin(), ports.end()), ports.end());
+  if (ports.empty()) {
+    return absl::NotFoundError("No candidate ports for the lidar");
+  }
+  return ports;
+}
+
+absl::StatusOr<LidarDiscovery::Probe> LidarDiscovery::ProbePort(
+    const std::string& usb_port, const std::vector<int32_t>& baud_rates,
+    const std::atomic<bool>& found) const {
+  absl::Status last_error = absl::NotFoundError("No baud rates to try");
+  for (int32_t baud_rate : baud_rates) {
+    if (found.load()) return absl::CancelledError("Found on another port");
+    auto driver = factory_(usb_port, baud_rate);
+    if (!driver.ok()) {
+      // The port itself is unusable, another rate won't help.
+      return driver.status();
+    }
+    auto device_info = (*driver)->GetDeviceInfo(options_.probe_timeout);
+    if (!device_info.ok()) {
+      last_error = device_info.status();
+      continue;
+    }
+    Probe probe;
+    probe.config.serial_number = FormatSerialNumber(*device_info);
+    if (!options_.serial_number.empty() &&
+        probe.config.serial_number != options_.serial_number) {
+      return absl::NotFoundError(absl::StrFormat(
+          "%s is device %s", usb_port, probe.config.serial_number));
+    }
+    probe.config.usb_port = usb_port;
+    probe.config.baud_rate = baud_rate;
+    probe.driver = *std::move(driver);
+    return probe;
+  }
+  return last_error;
+}
+
+absl::StatusOr<LidarDiscovery::Probe> LidarDiscovery::FindDevice(
+    const std::vector<std::string>& ports,
+    const std::vector<LidarConfig>& cache) {
+  auto state = std::make_shared<ProbeState>();
+  {
+    absl::MutexLock lock(&state->mutex);
+    state->outstanding = static_cast<int32_t>(ports.size());
+    state->errors.resize(ports.size());
+  }
+  for (size_t i = 0; i < ports.size(); ++i) {
+    const std::string& usb_port = ports[i];
+    std::vector<int32_t> baud_rates = options_.baud_rates;
+    auto cached = std::find_if(
+        cache.begin(), cache.end(),
+        [&usb_port](const LidarConfig& c) { return c.usb_port == usb_port; });
+    if (cached != cache.end()) {
+      std::erase(baud_rates, cached->baud_rate);
+      baud_rates.insert(baud_rates.begin(), cached->baud_rate);
+    }
+    probe_threads_.emplace_back([this, state, i, usb_port,
+                                 baud_rates = std::move(baud_rates)] {
+      auto probe = ProbePort(usb_port, baud_rates, state->found);
+      absl::MutexLock lock(&state->mutex);
+      if (!probe.ok()) {
+        state->errors[i] = probe.status();
+      } else if (!state->winner.has_value()) {
+        state->winner = *std::move(probe);
+        state->found.store(true);
+      }
+      // A device found after the winner is closed unused.
+      --state->outstanding;
+      state->done.Signal();
+    });
+  }
+
+  absl::MutexLock lock(&state->mutex);
+  while (!state->winner.has_value() && state->outstanding > 0) {
+    state->done.Wait(&state->mutex);
+  }
+  if (state->winner.has_value()) return *std::move(state->winner);
+  std::string errors;
+  for (size_t i = 0; i < ports.size(); ++i) {
+    absl::StrAppendFormat(&errors, " %s: %s;", ports[i],
+                          state->errors[i].message());
+  }
+  return absl::NotFoundError(absl::StrCat("No lidar found:", errors));
+}
+
+void LidarDiscovery::JoinProbes() {
+  for (std::thread& thread : probe_threads_) thread.join();
+  probe_threads_.clear();
+}
+
+void LidarDiscovery::SaveCache(const std::vector<LidarConfig>& cache) const {
+  if (options_.cache_path.empty()) return;
+  if (auto status = SaveLidarConfigCache(options_.cache_path, cache);
+      !status.ok()) {
+    LOG(WARNING) << "Lidar cache not updated: " << status.message();
+  }
+}
+
+absl::StatusOr<std::unique_ptr<Lidar>> LidarDiscovery::Discover() {
+  JoinProbes();
+  auto ports = CandidatePorts();
+  if (!ports.ok()) return ports.status();
+
+  // A broken cache only costs the fast path.
+  std::vector<LidarConfig> cache;
+  if (!options_.cache_path.empty()) {
+    cache = LoadLidarConfigCache(options_.cache_path)
+                .value_or(std::vector<LidarConfig>());
+  }
+
+  auto probe = FindDevice(*ports, cache);
+  if (!probe.ok()) return probe.status();
+
+  // Looked up by port like the baud rate, but only used for the same unit.
+  std::optional<uint16_t> scan_mode;
+  auto cached = std::find_if(cache.begin(), cache.end(),
+                             [&probe](const LidarConfig& c) {
+                               return c.usb_port == probe->config.usb_port;
+                             });
+  if (cached != cache.end() &&
+      cached->serial_number == probe->config.serial_number) {
+    scan_mode = cached->scan_mode;
+  }
+  auto lidar = Lidar::Create(std::move(probe->driver), scan_mode);
+  if (!lidar.ok() && scan_mode.has_value()) {
+    // The cached mode may be stale, e.g. after a firmware update. The failed
+    // driver is closed, so the port can be opened again.
+    cache.erase(cached);
+    auto driver = factory_(probe->config.usb_port, probe->config.baud_rate);
+    if (!driver.ok()) {
+      SaveCache(cache);
+      return driver.status();
+    }
+    lidar = Lidar::Create(*std::move(driver));
+    if (!lidar.ok()) {
+      SaveCache(cache);
+      return lidar.status();
+    }
+  }
+  if (!lidar.ok()) return lidar.status();
+  config_ = probe->config;
+  config_.scan_mode = (*lidar)->scan_mode();
+
+  std::erase_if(cache, [this](const LidarConfig& c) {
+    return c.serial_number == config_.serial_number ||
+           c.usb_port == config_.usb_port;
+  });
+  cache.push_back(config_);
+  SaveCache(cache);
+  return lidar;
+}
+
+}  // namespace slam_dunk
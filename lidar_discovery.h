@@ -0,0 +1,116 @@
+#ifndef SLAM_DUNK__LIDAR_DISCOVERY_H_
+#define SLAM_DUNK__LIDAR_DISCOVERY_H_
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "lidar.h"
+#include "lidar_driver.h"
+
+namespace slam_dunk {
+
+// How to reach one device.
+struct LidarConfig {
+  std::string serial_number;
+  std::string usb_port;
+  int32_t baud_rate = 0;
+  uint16_t scan_mode = 0;
+};
+
+// The cache is a text file with one "serial_number usb_port baud_rate
+// scan_mode" line per device. A missing file is an empty cache.
+absl::StatusOr<std::vector<LidarConfig>> LoadLidarConfigCache(
+    absl::string_view path);
+absl::Status SaveLidarConfigCache(absl::string_view path,
+                                  const std::vector<LidarConfig>& configs);
+
+// Finds a lidar without knowing its port or baud rate. Candidate ports are
+// probed in parallel; on each port the baud rates are tried in turn, the
+// cached one first, since one serial line can't talk at two rates at once.
+// The first device to answer wins without waiting for the other ports.
+// Its configuration is cached by port, so the next start skips both the
+// baud rate search and the scan mode query. The cache is best-effort: a
+// cached scan mode the device rejects is queried again, and a cache that
+// can't be written only logs a warning.
+class LidarDiscovery {
+ public:
+  struct Options {
+    // Glob patterns of the candidate ports.
+    std::vector<std::string> port_patterns = {"/dev/ttyUSB*"};
+    // A1 and A2M7 and older talk at 115200, A2M8+, A3 and S1 at 256000, S2
+    // at 1000000.
+    std::vector<int32_t> baud_rates = {115200, 256000, 1000000};
+    // How long to wait for a device to answer at one baud rate.
+    absl::Duration probe_timeout = absl::Milliseconds(300);
+    // Cache of working configurations, none if empty.
+    std::string cache_path;
+    // If not empty, only this device is accepted.
+    std::string serial_number;
+  };
+
+  LidarDiscovery() : LidarDiscovery(Options()) {}
+  explicit LidarDiscovery(const Options& options,
+                          DriverFactory factory = OpenSerialDriver);
+  // Waits for the probes that lost to time out.
+  ~LidarDiscovery();
+
+  // Not copyable, probe threads refer to it.
+  LidarDiscovery(const LidarDiscovery&) = delete;
+  LidarDiscovery& operator=(const LidarDiscovery&) = delete;
+
+  // Finds a device, starts it scanning in its fastest scan mode and updates
+  // the cache.
+  absl::StatusOr<std::unique_ptr<Lidar>> Discover();
+
+  // Configuration of the device found by the last Discover().
+  const LidarConfig& config() const { return config_; }
+
+ private:
+  struct Probe {
+    LidarConfig config;
+    std::unique_ptr<LidarDriver> driver;
+  };
+
+  // Probes of one Discover(), shared with the probe threads since these
+  // outlive the call.
+  struct ProbeState {
+    absl::Mutex mutex;
+    absl::CondVar done;
+    int32_t outstanding ABSL_GUARDED_BY(mutex) = 0;
+    std::optional<Probe> winner ABSL_GUARDED_BY(mutex);
+    std::vector<absl::Status> errors ABSL_GUARDED_BY(mutex);
+    // Set with the winner, lets the other probes stop early.
+    std::atomic<bool> found = false;
+  };
+
+  absl::StatusOr<std::vector<std::string>> CandidatePorts() const;
+  // Tries `baud_rates` on `usb_port` until a device answers.
+  absl::StatusOr<Probe> ProbePort(const std::string& usb_port,
+                                  const std::vector<int32_t>& baud_rates,
+                                  const std::atomic<bool>& found) const;
+  // Probes all ports and returns the first device that answers.
+  absl::StatusOr<Probe> FindDevice(const std::vector<std::string>& ports,
+                                   const std::vector<LidarConfig>& cache);
+  void JoinProbes();
+  // Writes the cache if there is one, warns if that fails.
+  void SaveCache(const std::vector<LidarConfig>& cache) const;
+
+  Options options_;
+  DriverFactory factory_;
+  LidarConfig config_;
+  // Probes that may still be running after Discover() returned.
+  std::vector<std::thread> probe_threads_;
+};
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK__LIDAR_DISCOVERY_H_
@@ -0,0 +1,185 @@
+#include "lidar_discovery.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "absl/status/status_matchers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "fake_lidar_driver.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace slam_dunk {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::Field;
+
+class LidarDiscoveryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = absl::StrCat(::testing::TempDir(), "/",
+                        ::testing::UnitTest::GetInstance()
+                            ->current_test_info()
+                            ->name());
+    std::filesystem::remove_all(dir_);
+    std::filesystem::create_directories(dir_);
+    options_.port_patterns = {absl::StrCat(dir_, "/ttyUSB*")};
+    options_.baud_rates = {115200, 256000, 1000000};
+    options_.probe_timeout = absl::Milliseconds(40);
+  }
+
+  // Creates the port file that discovery globs for.
+  std::string Port(int index) {
+    const std::string port = absl::StrCat(dir_, "/ttyUSB", index);
+    std::ofstream{port};
+    return port;
+  }
+
+  std::string dir_;
+  LidarDiscovery::Options options_;
+  FakeBus bus_;
+};
+
+TEST_F(LidarDiscoveryTest, FindsDeviceOnAnyPortAndBaudRate) {
+  Port(0);
+  FakeDevice device;
+  device.baud_rate = 256000;
+  bus_.Attach(Port(1), device);
+
+  LidarDiscovery discovery(options_, bus_.factory());
+  auto lidar = discovery.Discover();
+  ASSERT_THAT(lidar, IsOk());
+  EXPECT_EQ(discovery.config().usb_port, Port(1));
+  EXPECT_EQ(discovery.config().baud_rate, 256000);
+  EXPECT_EQ(discovery.config().scan_mode, 2);
+  EXPECT_EQ(bus_.started_mode(), 2);
+}
+
+TEST_F(LidarDiscoveryTest, ProbesPortsInParallel) {
+  // On each of the empty ports every baud rate times out.
+  for (int i = 0; i < 4; ++i) Port(i);
+  FakeDevice device;
+  device.baud_rate = 1000000;
+  bus_.Attach(Port(4), device);
+
+  LidarDiscovery discovery(options_, bus_.factory());
+  const absl::Time start = absl::Now();
+  ASSERT_THAT(discovery.Discover(), IsOk());
+  // One port after the other would take 5 * 3 * 40 ms.
+  EXPECT_LT(absl::Now() - start, absl::Milliseconds(400));
+}
+
+TEST_F(LidarDiscoveryTest, FirstAnswerDoesNotWaitForOtherPorts) {
+  options_.probe_timeout = absl::Milliseconds(500);
+  for (int i = 1; i < 4; ++i) Port(i);
+  bus_.Attach(Port(0), FakeDevice());
+
+  LidarDiscovery discovery(options_, bus_.factory());
+  const absl::Time start = absl::Now();
+  ASSERT_THAT(discovery.Discover(), IsOk());
+  EXPECT_LT(absl::Now() - start, absl::Milliseconds(250));
+  EXPECT_EQ(discovery.config().usb_port, Port(0));
+}
+
+TEST_F(LidarDiscoveryTest, CachedConfigurationSkipsSearch) {
+  options_.cache_path = absl::StrCat(dir_, "/lidar.cache");
+  FakeDevice device;
+  device.baud_rate = 1000000;
+  device.serial = 7;
+  bus_.Attach(Port(0), device);
+
+  LidarDiscovery first(options_, bus_.factory());
+  ASSERT_THAT(first.Discover(), IsOk());
+  EXPECT_EQ(bus_.opened(), 3);
+  EXPECT_EQ(bus_.scan_mode_queries(), 1);
+  EXPECT_THAT(
+      LoadLidarConfigCache(options_.cache_path),
+      IsOkAndHolds(ElementsAre(AllOf(
+          Field(&LidarConfig::serial_number,
+                "00000000000000000000000000000007"),
+          Field(&LidarConfig::usb_port, Port(0)),
+          Field(&LidarConfig::baud_rate, 1000000),
+          Field(&LidarConfig::scan_mode, 2)))));
+
+  LidarDiscovery second(options_, bus_.factory());
+  ASSERT_THAT(second.Discover(), IsOk());
+  EXPECT_EQ(bus_.opened(), 4);
+  EXPECT_EQ(bus_.scan_mode_queries(), 1);
+  EXPECT_EQ(second.config().scan_mode, 2);
+}
+
+TEST_F(LidarDiscoveryTest, StaleScanModeIsQueriedAgain) {
+  options_.cache_path = absl::StrCat(dir_, "/lidar.cache");
+  FakeDevice device;
+  device.serial = 7;
+  bus_.Attach(Port(0), device);
+  ASSERT_THAT(SaveLidarConfigCache(
+                  options_.cache_path,
+                  {{.serial_number = "00000000000000000000000000000007",
+                    .usb_port = Port(0),
+                    .baud_rate = 115200,
+                    .scan_mode = 9}}),
+              IsOk());
+
+  LidarDiscovery discovery(options_, bus_.factory());
+  ASSERT_THAT(discovery.Discover(), IsOk());
+  EXPECT_EQ(discovery.config().scan_mode, 2);
+  EXPECT_EQ(bus_.scan_mode_queries(), 1);
+  EXPECT_THAT(LoadLidarConfigCache(options_.cache_path),
+              IsOkAndHolds(ElementsAre(Field(&LidarConfig::scan_mode, 2))));
+}
+
+TEST_F(LidarDiscoveryTest, UnwritableCacheStillStartsLidar) {
+  options_.cache_path = absl::StrCat(dir_, "/missing/lidar.cache");
+  bus_.Attach(Port(0), FakeDevice());
+
+  LidarDiscovery discovery(options_, bus_.factory());
+  auto lidar = discovery.Discover();
+  ASSERT_THAT(lidar, IsOk());
+  EXPECT_EQ(bus_.started_mode(), 2);
+}
+
+TEST_F(LidarDiscoveryTest, MatchesSerialNumber) {
+  FakeDevice first;
+  first.serial = 1;
+  bus_.Attach(Port(0), first);
+  FakeDevice second;
+  second.serial = 2;
+  bus_.Attach(Port(1), second);
+
+  options_.serial_number = "00000000000000000000000000000002";
+  LidarDiscovery discovery(options_, bus_.factory());
+  ASSERT_THAT(discovery.Discover(), IsOk());
+  EXPECT_EQ(discovery.config().usb_port, Port(1));
+}
+
+TEST_F(LidarDiscoveryTest, NoDevice) {
+  Port(0);
+  LidarDiscovery discovery(options_, bus_.factory());
+  EXPECT_THAT(discovery.Discover(), StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_F(LidarDiscoveryTest, NoPorts) {
+  LidarDiscovery discovery(options_, bus_.factory());
+  EXPECT_THAT(discovery.Discover(), StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(LidarConfigCacheTest, MissingFileIsEmpty) {
+  EXPECT_THAT(LoadLidarConfigCache("/nonexistent/lidar.cache"),
+              IsOkAndHolds(::testing::IsEmpty()));
+}
+
+TEST(LidarConfigCacheTest, MalformedLine) {
+  const std::string path = absl::StrCat(::testing::TempDir(), "/bad.cache");
+  std::ofstream{path} << "ABC /dev/ttyUSB0 fast 2\n";
+  EXPECT_THAT(LoadLidarConfigCache(path),
+              StatusIs(absl::StatusCode::kDataLoss));
+}
+
+}  // namespace
+}  // namespace slam_dunk
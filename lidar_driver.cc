@@ -0,0 +1,119 @@
+#include "lidar_driver.h"
+#include <algorithm>
+#include <utility>
+#include "absl/memory/memory.h"
+#include "absl/strings/str_format.h"
+
+namespace slam_dunk {
+namespace {
+
+sl_u32 ToMilliseconds(absl::Duration timeout) {
+  return static_cast<sl_u32>(absl::ToInt64Milliseconds(timeout));
+}
+
+class SlamtecDriver : public LidarDriver {
+ public:
+  SlamtecDriver(std::unique_ptr<sl::IChannel> channel,
+                std::unique_ptr<sl::ILidarDriver> driver)
+      : channel_(std::move(channel)), driver_(std::move(driver)) {}
+  ~SlamtecDriver() override { driver_->disconnect(); }
+
+  absl::StatusOr<sl_lidar_response_device_info_t> GetDeviceInfo(
+      absl::Duration timeout) override {
+    sl_lidar_response_device_info_t device_info;
+    sl_result status =
+        driver_->getDeviceInfo(device_info, ToMilliseconds(timeout));
+    if (SL_IS_FAIL(status)) {
+      return absl::UnavailableError(
+          absl::StrFormat("Failed to getDeviceInfo: 0%x", status));
+    }
+    return device_info;
+  }
+
+  absl::StatusOr<std::vector<ScanMode>> GetScanModes() override {
+    std::vector<sl::LidarScanMode> scan_modes;
+    sl_result status = driver_->getAllSupportedScanModes(scan_modes);
+    if (SL_IS_FAIL(status)) {
+      return absl::InternalError(
+          absl::StrFormat("Failed to getAllSupportedScanModes: 0%x", status));
+    }
+    std::vector<ScanMode> modes;
+    for (const sl::LidarScanMode& mode : scan_modes) {
+      modes.push_back(ScanMode{.id = mode.id,
+                               .us_per_sample = mode.us_per_sample,
+                               .max_distance_m = mode.max_distance,
+                               .name = mode.scan_mode});
+    }
+    return modes;
+  }
+
+  absl::Status StartScan(uint16_t scan_mode) override {
+    sl_result status = driver_->startScan(/*force=*/false, scan_mode);
+    if (SL_IS_FAIL(status)) {
+      return absl::InternalError(
+          absl::StrFormat("Failed to startScan: 0%x", status));
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status GrabScanDataHq(sl_lidar_response_measurement_node_hq_t* nodes,
+                              size_t& count, absl::Duration timeout) override {
+    sl_result status =
+        driver_->grabScanDataHq(nodes, count, ToMilliseconds(timeout));
+    if (SL_IS_FAIL(status)) {
+      return absl::InternalError(
+          absl::StrFormat("Failed to grabScanDataHq: 0%x", status));
+    }
+    return absl::OkStatus();
+  }
+
+  void Stop() override { driver_->stop(); }
+
+ private:
+  // The driver uses the channel, so it is declared last to go first.
+  std::unique_ptr<sl::IChannel> channel_;
+  std::unique_ptr<sl::ILidarDriver> driver_;
+};
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<LidarDriver>> OpenSerialDriver(
+    absl::string_view usb_port, int32_t baud_rate) {
+  auto driver_result = sl::createLidarDriver();
+  if (!driver_result)
+    return absl::InternalError("Failed in sl::createLidarDriver()");
+  std::unique_ptr<sl::ILidarDriver> driver =
+      absl::WrapUnique(driver_result.value);
+
+  auto channel_status =
+      sl::createSerialPortChannel(std::string(usb_port), baud_rate);
+  if (!channel_status)
+    return absl::InternalError("Failed in sl::createSerialPortChannel");
+  std::unique_ptr<sl::IChannel> channel =
+      absl::WrapUnique(channel_status.value);
+
+  sl_result status = driver->connect(channel.get());
+  if (SL_IS_FAIL(status)) {
+    return absl::UnavailableError(
+        absl::StrFormat("Failed to connect to %s: 0%x", usb_port, status));
+  }
+  return std::make_unique<SlamtecDriver>(std::move(channel), std::move(driver));
+}
+
+std::string FormatSerialNumber(const sl_lidar_response_device_info_t& info) {
+  std::string serial_number;
+  for (uint8_t n : info.serialnum) {
+    serial_number += absl::StrFormat("%02X", n);
+  }
+  return serial_number;
+}
+
+const ScanMode* FastestScanMode(const std::vector<ScanMode>& modes) {
+  auto fastest = std::min_element(
+      modes.begin(), modes.end(), [](const ScanMode& a, const ScanMode& b) {
+        return a.us_per_sample < b.us_per_sample;
+      });
+  return fastest == modes.end() ? nullptr : &*fastest;
+}
+
+}  // namespace slam_dunk
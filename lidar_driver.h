@@ -0,0 +1,61 @@
+#ifndef SLAM_DUNK__LIDAR_DRIVER_H_
+#define SLAM_DUNK__LIDAR_DRIVER_H_
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "third_party/rplidar/include/sl_lidar_driver.h"
+
+namespace slam_dunk {
+
+// Scan mode supported by the device.
+struct ScanMode {
+  uint16_t id = 0;
+  // Time between two samples, the lower the denser a revolution.
+  float us_per_sample = 0;
+  float max_distance_m = 0;
+  std::string name;
+};
+
+// The part of the Slamtec driver that Lidar uses, connected to one device.
+// Lets tests run Lidar and discovery against fake devices.
+class LidarDriver {
+ public:
+  virtual ~LidarDriver() = default;
+
+  virtual absl::StatusOr<sl_lidar_response_device_info_t> GetDeviceInfo(
+      absl::Duration timeout) = 0;
+  virtual absl::StatusOr<std::vector<ScanMode>> GetScanModes() = 0;
+  virtual absl::Status StartScan(uint16_t scan_mode) = 0;
+  // Waits up to `timeout` for a complete revolution and stores up to
+  // `count` of its samples in `nodes`; `count` is set to the number stored.
+  virtual absl::Status GrabScanDataHq(
+      sl_lidar_response_measurement_node_hq_t* nodes, size_t& count,
+      absl::Duration timeout) = 0;
+  virtual void Stop() = 0;
+};
+
+// Opens a driver for the device on `usb_port` at `baud_rate`. The device
+// may not be there; calls to GetDeviceInfo tell.
+using DriverFactory =
+    std::function<absl::StatusOr<std::unique_ptr<LidarDriver>>(
+        absl::string_view usb_port, int32_t baud_rate)>;
+
+// DriverFactory for RPLidar devices on a serial port, using the Slamtec SDK.
+absl::StatusOr<std::unique_ptr<LidarDriver>> OpenSerialDriver(
+    absl::string_view usb_port, int32_t baud_rate);
+
+// Serial number as the hex string printed on the device.
+std::string FormatSerialNumber(const sl_lidar_response_device_info_t& info);
+
+// The scan mode with the highest sample rate, nullptr if `modes` is empty.
+const ScanMode* FastestScanMode(const std::vector<ScanMode>& modes);
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK__LIDAR_DRIVER_H_
@@ -0,0 +1,114 @@
+#include "lidar.h"
+#include <algorithm>
+#include "absl/status/status_matchers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "fake_lidar_driver.h"
+#include "gtest/gtest.h"
+
+namespace slam_dunk {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+
+absl::StatusOr<std::unique_ptr<Lidar>> CreateLidar(FakeBus& bus,
+                                                   FakeDevice device) {
+  const int32_t baud_rate = device.baud_rate;
+  bus.Attach("/dev/ttyUSB0", std::move(device));
+  auto driver = bus.factory()("/dev/ttyUSB0", baud_rate);
+  if (!driver.ok()) return driver.status();
+  return Lidar::Create(*std::move(driver));
+}
+
+TEST(LidarTest, StartsFastestScanMode) {
+  FakeBus bus;
+  auto lidar = CreateLidar(bus, FakeDevice());
+  ASSERT_THAT(lidar, IsOk());
+  EXPECT_EQ((*lidar)->scan_mode(), 2);
+  EXPECT_EQ(bus.started_mode(), 2);
+  EXPECT_EQ((*lidar)->GetDeviceInfo().serial_number,
+            "00000000000000000000000000000001");
+}
+
+TEST(LidarTest, ScanReturnsRequestedCount) {
+  FakeBus bus;
+  auto lidar = CreateLidar(bus, FakeDevice());
+  ASSERT_THAT(lidar, IsOk());
+  auto scan = (*lidar)->Scan(1024);
+  ASSERT_THAT(scan, IsOk());
+  ASSERT_EQ(scan->size(), 1024);
+  EXPECT_TRUE(std::is_sorted(scan->begin(), scan->end()));
+  EXPECT_EQ(scan->front().distance_mm, 4000);
+}
+
+TEST(LidarTest, WaitsForFirstRevolutionWithReturns) {
+  FakeBus bus;
+  FakeDevice device;
+  device.spin_up_revolutions = 4;
+  device.revolution_time = absl::Milliseconds(10);
+  auto lidar = CreateLidar(bus, device);
+  ASSERT_THAT(lidar, IsOk());
+
+  auto ready = (*lidar)->WaitForFirstRevolution(absl::Seconds(1), 512);
+  ASSERT_THAT(ready, IsOk());
+  EXPECT_GE(*ready, absl::Milliseconds(50));
+  EXPECT_LT(*ready, absl::Seconds(1));
+  RecordProperty("time_to_first_revolution_ms",
+                 absl::StrCat(absl::ToDoubleMilliseconds(*ready)));
+
+  // The revolution that made the lidar ready is not thrown away.
+  const absl::Time start = absl::Now();
+  auto scan = (*lidar)->Scan(512);
+  EXPECT_LT(absl::Now() - start, absl::Milliseconds(10));
+  ASSERT_THAT(scan, IsOk());
+  EXPECT_EQ(scan->front().distance_mm, 4000);
+}
+
+TEST(LidarTest, ScanReturnsShortRevolution) {
+  FakeBus bus;
+  FakeDevice device;
+  device.samples_per_revolution = 600;
+  auto lidar = CreateLidar(bus, device);
+  ASSERT_THAT(lidar, IsOk());
+  auto scan = (*lidar)->Scan();
+  ASSERT_THAT(scan, IsOk());
+  EXPECT_EQ(scan->size(), 600);
+}
+
+TEST(LidarTest, ScanAfterFirstRevolutionDoesNotGrab) {
+  FakeBus bus;
+  auto lidar = CreateLidar(bus, FakeDevice());
+  ASSERT_THAT(lidar, IsOk());
+  // A revolution has fewer samples than the default count asks for.
+  ASSERT_THAT((*lidar)->WaitForFirstRevolution(), IsOk());
+  ASSERT_EQ(bus.grabs(), 1);
+  auto scan = (*lidar)->Scan();
+  ASSERT_THAT(scan, IsOk());
+  EXPECT_EQ(scan->size(), 1600);
+  EXPECT_EQ(bus.grabs(), 1);
+}
+
+TEST(LidarTest, ScanWithOtherCountSkipsBufferedRevolution) {
+  FakeBus bus;
+  FakeDevice device;
+  auto lidar = CreateLidar(bus, device);
+  ASSERT_THAT(lidar, IsOk());
+  ASSERT_THAT((*lidar)->WaitForFirstRevolution(absl::Seconds(1), 512), IsOk());
+  auto scan = (*lidar)->Scan(256);
+  ASSERT_THAT(scan, IsOk());
+  EXPECT_EQ(scan->size(), 256);
+}
+
+TEST(LidarTest, FirstRevolutionTimesOut) {
+  FakeBus bus;
+  FakeDevice device;
+  device.spin_up_revolutions = 1000;
+  auto lidar = CreateLidar(bus, device);
+  ASSERT_THAT(lidar, IsOk());
+  EXPECT_THAT((*lidar)->WaitForFirstRevolution(absl::Milliseconds(50), 64),
+              StatusIs(absl::StatusCode::kDeadlineExceeded));
+}
+
+}  // namespace
+}  // namespace slam_dunk
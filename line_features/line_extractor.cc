@@ -0,0 +1,121 @@
+#include "line_features/line_extractor.h"
+#include <algorithm>
+#include <cmath>
+#include "scan_geometry.h"
+
+namespace slam_dunk {
+namespace {
+
+// Number of points accepted unconditionally before a line is trusted.
+constexpr int32_t kSeedPoints = 3;
+
+// Normal of the best fit line, computed with half-angle identities instead
+// of atan2/cos/sin since it is refreshed for every point.
+struct Normal {
+  double c = 1;
+  double s = 0;
+  double rho = 0;
+
+  double DistanceTo(const Eigen::Vector2d& p) const {
+    return std::abs(p.x() * c + p.y() * s - rho);
+  }
+};
+
+Normal FitNormal(const LineMoments& moments) {
+  const double n = moments.n;
+  const double mx = moments.sx / n;
+  const double my = moments.sy / n;
+  // (cos(2 alpha), sin(2 alpha)) is parallel to (cyy - cxx, -2 cxy).
+  const double u = (moments.syy / n - my * my) - (moments.sxx / n - mx * mx);
+  const double v = -2.0 * (moments.sxy / n - mx * my);
+  const double norm = std::hypot(u, v);
+  const double cos2 = norm > 0 ? u / norm : 1.0;
+  Normal normal;
+  normal.c = std::sqrt(std::max(0.0, 0.5 * (1.0 + cos2)));
+  normal.s = std::copysign(std::sqrt(std::max(0.0, 0.5 * (1.0 - cos2))), v);
+  normal.rho = mx * normal.c + my * normal.s;
+  return normal;
+}
+
+}  // namespace
+
+std::vector<LineSegment> LineExtractor::Extract(
+    const std::vector<ScanResponse>& scan) {
+  std::vector<LineSegment> segments;
+  Extract(scan, segments);
+  return segments;
+}
+
+void LineExtractor::Extract(const std::vector<ScanResponse>& scan,
+                            std::vector<LineSegment>& segments) {
+  segments.clear();
+  runs_.clear();
+
+  Run run;
+  Normal line;
+  for (const auto& response : scan) {
+    if (!IsValid(response)) continue;
+    const Eigen::Vector2d p = ToCartesian(response);
+
+    bool fits = run.moments.n == 0;
+    if (!fits && (p - run.last).norm() <= options_.max_gap_m) {
+      fits = run.moments.n < kSeedPoints ||
+             line.DistanceTo(p) <= options_.max_point_distance_m;
+    }
+    if (!fits) {
+      CloseRun(run);
+      run = Run();
+    }
+    if (run.moments.n == 0) run.first = p;
+    run.moments.Add(p);
+    run.last = p;
+    if (run.moments.n >= kSeedPoints) {
+      line = FitNormal(run.moments);
+    }
+  }
+  if (run.moments.n > 0) CloseRun(run);
+
+  // Merge neighbours, including the wall split by the start of revolution.
+  std::vector<Run> merged;
+  merged.reserve(runs_.size());
+  for (const auto& next : runs_) {
+    if (!merged.empty() && CanMerge(merged.back(), next)) {
+      merged.back().moments += next.moments;
+      merged.back().last = next.last;
+    } else {
+      merged.push_back(next);
+    }
+  }
+  if (merged.size() > 1 && CanMerge(merged.back(), merged.front())) {
+    merged.back().moments += merged.front().moments;
+    merged.back().last = merged.front().last;
+    merged.erase(merged.begin());
+  }
+
+  for (const auto& r : merged) {
+    LineSegment segment = FitLine(r.moments, r.first, r.last, options_.sigma_m);
+    if (segment.num_points < options_.min_points ||
+        segment.Length() < options_.min_length_m) {
+      continue;
+    }
+    segments.push_back(segment);
+  }
+}
+
+void LineExtractor::CloseRun(const Run& run) {
+  // Runs below min_points are kept until merging, they may glue bigger
+  // pieces. Runs too short to define a line are dropped, usually stray
+  // points between objects.
+  if (run.moments.n >= kSeedPoints) runs_.push_back(run);
+}
+
+bool LineExtractor::CanMerge(const Run& a, const Run& b) const {
+  if ((b.first - a.last).norm() > options_.max_gap_m) return false;
+  const LineSegment la = FitLine(a.moments, a.first, a.last, options_.sigma_m);
+  const LineSegment lb = FitLine(b.moments, b.first, b.last, options_.sigma_m);
+  return std::abs(la.rho - lb.rho) <= options_.merge_rho_m &&
+         std::abs(NormalizeAngle(la.alpha - lb.alpha)) <=
+             options_.merge_alpha_rad;
+}
+
+}  // namespace slam_dunk
@@ -0,0 +1,63 @@
+// Extraction of line segments from one lidar revolution.
+#ifndef SLAM_DUNK_LINE_FEATURES_LINE_EXTRACTOR_H_
+#define SLAM_DUNK_LINE_FEATURES_LINE_EXTRACTOR_H_
+#include <cstdint>
+#include <vector>
+#include "lidar.h"
+#include "line_features/line_segment.h"
+
+namespace slam_dunk {
+
+// Incremental line fitting over angularly ordered scans. Consecutive points
+// are added to the current line as long as they stay close to it; adjacent
+// collinear segments are merged afterwards. Both steps are linear in the
+// number of points.
+class LineExtractor {
+ public:
+  struct Options {
+    // Maximum distance of a new point from the line being grown.
+    double max_point_distance_m = 0.03;
+    // Maximum distance between consecutive points of one segment.
+    double max_gap_m = 0.2;
+    // Segments with fewer points or shorter length are dropped.
+    int32_t min_points = 8;
+    double min_length_m = 0.15;
+    // Standard deviation of point noise used for segment covariance.
+    double sigma_m = 0.01;
+    // Adjacent segments closer than this in (rho, alpha) are merged.
+    double merge_rho_m = 0.05;
+    double merge_alpha_rad = 0.05;
+  };
+
+  LineExtractor() : LineExtractor(Options()) {}
+  explicit LineExtractor(const Options& options) : options_(options) {}
+
+  // Returns segments of a scan sorted by theta, e.g. from Lidar::Scan.
+  // Samples with zero distance are skipped.
+  std::vector<LineSegment> Extract(const std::vector<ScanResponse>& scan);
+
+  // Same as above, but reuses `segments` storage between revolutions.
+  void Extract(const std::vector<ScanResponse>& scan,
+               std::vector<LineSegment>& segments);
+
+ private:
+  // Segment under construction.
+  struct Run {
+    LineMoments moments;
+    Eigen::Vector2d first = Eigen::Vector2d::Zero();
+    Eigen::Vector2d last = Eigen::Vector2d::Zero();
+  };
+
+  // Moves accepted run into runs_.
+  void CloseRun(const Run& run);
+  // Returns true if two runs fit one line.
+  bool CanMerge(const Run& a, const Run& b) const;
+
+  Options options_;
+  // Reused between calls to avoid allocations per revolution.
+  std::vector<Run> runs_;
+};
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_LINE_FEATURES_LINE_EXTRACTOR_H_
@@ -0,0 +1,58 @@
+// Extraction time per revolution.
+// blaze run -c opt //line_features:line_extractor_benchmark
+#include <benchmark/benchmark.h>
+#include "line_features/line_extractor.h"
+#include "line_features/line_map.h"
+#include "simulated_scan.h"
+
+namespace slam_dunk {
+namespace {
+
+SimulatedWorld MakeWorld() {
+  SimulatedWorld world = SimulatedWorld::Room(12, 8);
+  world.walls.push_back({{6, 0}, {6, 3}});
+  world.walls.push_back({{6, 5}, {6, 8}});
+  world.circles.push_back({{3, 3}, 0.3});
+  return world;
+}
+
+void BM_ExtractRevolution(benchmark::State& state) {
+  const auto scan = SimulateScan(MakeWorld(), Pose2d{.x = 3, .y = 5},
+                                 state.range(0), /*range_sigma_m=*/0.01);
+  LineExtractor extractor;
+  std::vector<LineSegment> segments;
+  for (auto _ : state) {
+    extractor.Extract(scan, segments);
+    benchmark::DoNotOptimize(segments.data());
+  }
+  state.counters["segments"] = segments.size();
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ExtractRevolution)->Arg(2048)->Arg(4096)->Arg(8192);
+
+// Reports memory of a line map next to a 5 cm occupancy grid.
+void BM_BuildMap(benchmark::State& state) {
+  const SimulatedWorld world = MakeWorld();
+  const Pose2d pose{.x = 3, .y = 5};
+  LineExtractor extractor;
+  std::vector<std::vector<LineSegment>> revolutions;
+  for (uint32_t seed = 1; seed <= 20; ++seed) {
+    revolutions.push_back(
+        extractor.Extract(SimulateScan(world, pose, 8192, 0.01, seed)));
+  }
+  size_t bytes = 0;
+  for (auto _ : state) {
+    LineMap map;
+    for (const auto& segments : revolutions) map.Insert(segments, pose);
+    bytes = map.ByteSize();
+    benchmark::DoNotOptimize(bytes);
+  }
+  state.counters["map_bytes"] = bytes;
+  state.counters["grid_bytes"] = (12 / 0.05) * (8 / 0.05);
+}
+BENCHMARK(BM_BuildMap);
+
+}  // namespace
+}  // namespace slam_dunk
+
+BENCHMARK_MAIN();
@@ -0,0 +1,78 @@
+#include "line_features/line_extractor.h"
+#include <algorithm>
+#include <cmath>
+#include "gmock/gmock-matchers.h"
+#include "gtest/gtest.h"
+#include "simulated_scan.h"
+
+namespace slam_dunk {
+namespace {
+
+using ::testing::DoubleNear;
+using ::testing::SizeIs;
+
+TEST(LineExtractor, RoomHasFourWalls) {
+  // Lidar at (2, 1.5) in a 6 x 4 room, looking along x.
+  const Pose2d pose{.x = 2, .y = 1.5, .theta = 0};
+  const auto scan = SimulateScan(SimulatedWorld::Room(6, 4), pose,
+                                 /*count=*/2048, /*range_sigma_m=*/0.005);
+  LineExtractor extractor;
+  auto segments = extractor.Extract(scan);
+  ASSERT_THAT(segments, SizeIs(4));
+
+  // Distances to the walls from the lidar.
+  std::vector<double> rhos;
+  for (const auto& segment : segments) rhos.push_back(segment.rho);
+  std::sort(rhos.begin(), rhos.end());
+  EXPECT_THAT(rhos[0], DoubleNear(1.5, 0.02));
+  EXPECT_THAT(rhos[1], DoubleNear(2.0, 0.02));
+  EXPECT_THAT(rhos[2], DoubleNear(2.5, 0.02));
+  EXPECT_THAT(rhos[3], DoubleNear(4.0, 0.02));
+
+  for (const auto& segment : segments) {
+    // Walls are axis aligned.
+    const double to_axis = std::remainder(segment.alpha, M_PI / 2);
+    EXPECT_THAT(to_axis, DoubleNear(0, 0.01));
+    EXPECT_GT(segment.Length(), 3.0);
+    EXPECT_GT(segment.covariance(0, 0), 0);
+    EXPECT_GT(segment.covariance(1, 1), 0);
+  }
+}
+
+TEST(LineExtractor, SkipsInvalidPoints) {
+  std::vector<ScanResponse> scan(100);
+  LineExtractor extractor;
+  EXPECT_THAT(extractor.Extract(scan), SizeIs(0));
+}
+
+TEST(LineExtractor, ReusesOutput) {
+  const auto scan = SimulateScan(SimulatedWorld::Room(6, 4),
+                                 Pose2d{.x = 3, .y = 2}, /*count=*/2048);
+  LineExtractor extractor;
+  std::vector<LineSegment> segments;
+  extractor.Extract(scan, segments);
+  extractor.Extract(scan, segments);
+  EXPECT_THAT(segments, SizeIs(4));
+}
+
+TEST(TransformSegment, RoundTrip) {
+  const auto scan = SimulateScan(SimulatedWorld::Room(6, 4),
+                                 Pose2d{.x = 3, .y = 2}, /*count=*/2048);
+  LineExtractor extractor;
+  const auto segments = extractor.Extract(scan);
+  ASSERT_FALSE(segments.empty());
+  const Pose2d pose{.x = 1, .y = -2, .theta = 0.7};
+  const Pose2d inverse{
+      .x = -(std::cos(pose.theta) * pose.x + std::sin(pose.theta) * pose.y),
+      .y = std::sin(pose.theta) * pose.x - std::cos(pose.theta) * pose.y,
+      .theta = -pose.theta};
+  const LineSegment back =
+      TransformSegment(TransformSegment(segments[0], pose), inverse);
+  EXPECT_THAT(back.rho, DoubleNear(segments[0].rho, 1e-9));
+  EXPECT_THAT(back.alpha, DoubleNear(segments[0].alpha, 1e-9));
+  EXPECT_THAT(back.covariance(0, 0),
+              DoubleNear(segments[0].covariance(0, 0), 1e-12));
+}
+
+}  // namespace
+}  // namespace slam_dunk
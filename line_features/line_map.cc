@@ -0,0 +1,87 @@
+#include "line_features/line_map.h"
+#include <algorithm>
+#include <cmath>
+#include <Eigen/Dense>
+
+namespace slam_dunk {
+
+LineSegment FuseSegments(const LineSegment& a, const LineSegment& b) {
+  // Express b relative to a so that neither rho sign nor alpha wraps.
+  const LineSegment aligned = AlignNormal(b, a.alpha);
+  const Eigen::Matrix2d info_a = a.covariance.inverse();
+  const Eigen::Matrix2d info_b = aligned.covariance.inverse();
+  const Eigen::Vector2d xa(a.rho, a.alpha);
+  const Eigen::Vector2d xb(aligned.rho,
+                           a.alpha + NormalizeAngle(aligned.alpha - a.alpha));
+
+  LineSegment fused;
+  fused.covariance = (info_a + info_b).inverse();
+  const Eigen::Vector2d x = fused.covariance * (info_a * xa + info_b * xb);
+  fused.rho = x(0);
+  fused.alpha = NormalizeAngle(x(1));
+  fused.num_points = a.num_points + b.num_points;
+  if (fused.rho < 0) {
+    fused.rho = -fused.rho;
+    fused.alpha = NormalizeAngle(fused.alpha + M_PI);
+    fused.covariance(0, 1) = -fused.covariance(0, 1);
+    fused.covariance(1, 0) = -fused.covariance(1, 0);
+  }
+
+  // Extremes of the four end points along the fused line.
+  const Eigen::Vector2d normal(std::cos(fused.alpha), std::sin(fused.alpha));
+  const Eigen::Vector2d base = fused.rho * normal;
+  double lo = fused.Along(a.start);
+  double hi = lo;
+  for (const auto& p : {a.end, b.start, b.end}) {
+    lo = std::min(lo, fused.Along(p));
+    hi = std::max(hi, fused.Along(p));
+  }
+  const Eigen::Vector2d direction(-normal.y(), normal.x());
+  fused.start = base + lo * direction;
+  fused.end = base + hi * direction;
+  return fused;
+}
+
+int32_t LineMap::FindMatch(const LineSegment& segment, double rho_gate_m,
+                           double alpha_gate_rad) const {
+  int32_t best = -1;
+  double best_score = 0;
+  for (size_t i = 0; i < segments_.size(); ++i) {
+    const LineSegment& candidate = segments_[i];
+    const LineSegment aligned = AlignNormal(segment, candidate.alpha);
+    const double d_rho = std::abs(candidate.rho - aligned.rho);
+    const double d_alpha =
+        std::abs(NormalizeAngle(candidate.alpha - aligned.alpha));
+    if (d_rho > rho_gate_m || d_alpha > alpha_gate_rad) continue;
+    // Intervals along the candidate line must overlap or nearly touch.
+    double lo = candidate.Along(segment.start);
+    double hi = candidate.Along(segment.end);
+    if (lo > hi) std::swap(lo, hi);
+    double c_lo = candidate.Along(candidate.start);
+    double c_hi = candidate.Along(candidate.end);
+    if (c_lo > c_hi) std::swap(c_lo, c_hi);
+    if (lo > c_hi + options_.max_gap_m || hi < c_lo - options_.max_gap_m) {
+      continue;
+    }
+    const double score = d_rho / rho_gate_m + d_alpha / alpha_gate_rad;
+    if (best < 0 || score < best_score) {
+      best = static_cast<int32_t>(i);
+      best_score = score;
+    }
+  }
+  return best;
+}
+
+void LineMap::Insert(const std::vector<LineSegment>& segments,
+                     const Pose2d& pose) {
+  for (const auto& segment : segments) {
+    const LineSegment in_map = TransformSegment(segment, pose);
+    if (const int32_t match = FindMatch(in_map); match >= 0) {
+      segments_[match] = FuseSegments(segments_[match], in_map);
+    } else {
+      segments_.push_back(in_map);
+    }
+  }
+}
+
+}  // namespace slam_dunk
@@ -0,0 +1,55 @@
+// Compact map made of line segments.
+#ifndef SLAM_DUNK_LINE_FEATURES_LINE_MAP_H_
+#define SLAM_DUNK_LINE_FEATURES_LINE_MAP_H_
+#include <cstddef>
+#include <vector>
+#include "line_features/line_segment.h"
+#include "scan_geometry.h"
+
+namespace slam_dunk {
+
+// Stores segments in the map frame. A wall observed many times is kept
+// as a single segment, so the map grows with the number of walls rather
+// than with the explored area as occupancy grids do.
+class LineMap {
+ public:
+  struct Options {
+    // Gates for considering two segments the same wall.
+    double rho_gate_m = 0.1;
+    double alpha_gate_rad = 0.1;
+    // Collinear segments further apart than this stay separate.
+    double max_gap_m = 0.3;
+  };
+
+  LineMap() : LineMap(Options()) {}
+  explicit LineMap(const Options& options) : options_(options) {}
+
+  // Adds segments observed by the lidar at `pose` in the map frame.
+  // Each segment is either fused with the matching map segment or appended.
+  void Insert(const std::vector<LineSegment>& segments, const Pose2d& pose);
+
+  // Returns index of the map segment matching `segment` given in the map
+  // frame or -1. Uses gates from options unless given explicitly.
+  int32_t FindMatch(const LineSegment& segment) const {
+    return FindMatch(segment, options_.rho_gate_m, options_.alpha_gate_rad);
+  }
+  int32_t FindMatch(const LineSegment& segment, double rho_gate_m,
+                    double alpha_gate_rad) const;
+
+  const std::vector<LineSegment>& segments() const { return segments_; }
+
+  // Memory taken by the segments.
+  size_t ByteSize() const { return segments_.size() * sizeof(LineSegment); }
+
+ private:
+  Options options_;
+  std::vector<LineSegment> segments_;
+};
+
+// Fuses two observations of the same line weighting them by their
+// covariances. End points are extended to cover both segments.
+LineSegment FuseSegments(const LineSegment& a, const LineSegment& b);
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_LINE_FEATURES_LINE_MAP_H_
@@ -0,0 +1,110 @@
+#include "line_features/line_segment.h"
+#include <cmath>
+
+namespace slam_dunk {
+namespace {
+
+// Unit vector along the line with normal direction alpha.
+Eigen::Vector2d Direction(double alpha) {
+  return {-std::sin(alpha), std::cos(alpha)};
+}
+
+// Represents the line with the opposite normal.
+void Flip(LineSegment& segment) {
+  segment.rho = -segment.rho;
+  segment.alpha = NormalizeAngle(segment.alpha + M_PI);
+  // d(-rho)/d(alpha + pi) flips the cross term.
+  segment.covariance(0, 1) = -segment.covariance(0, 1);
+  segment.covariance(1, 0) = -segment.covariance(1, 0);
+}
+
+// Keeps rho non-negative.
+void Canonicalize(LineSegment& segment) {
+  if (segment.rho < 0) Flip(segment);
+}
+
+}  // namespace
+
+LineMoments& LineMoments::operator+=(const LineMoments& that) {
+  n += that.n;
+  sx += that.sx;
+  sy += that.sy;
+  sxx += that.sxx;
+  syy += that.syy;
+  sxy += that.sxy;
+  return *this;
+}
+
+double LineSegment::DistanceTo(const Eigen::Vector2d& p) const {
+  return std::abs(p.x() * std::cos(alpha) + p.y() * std::sin(alpha) - rho);
+}
+
+double LineSegment::Along(const Eigen::Vector2d& p) const {
+  return p.dot(Direction(alpha));
+}
+
+double NormalizeAngle(double angle) {
+  angle = std::remainder(angle, 2.0 * M_PI);
+  return angle <= -M_PI ? angle + 2.0 * M_PI : angle;
+}
+
+LineSegment FitLine(const LineMoments& moments, const Eigen::Vector2d& first,
+                    const Eigen::Vector2d& last, double sigma_m) {
+  const double n = moments.n;
+  const double mx = moments.sx / n;
+  const double my = moments.sy / n;
+  // Central second moments.
+  const double cxx = moments.sxx / n - mx * mx;
+  const double cyy = moments.syy / n - my * my;
+  const double cxy = moments.sxy / n - mx * my;
+
+  LineSegment segment;
+  segment.alpha = 0.5 * std::atan2(-2.0 * cxy, cyy - cxx);
+  const double c = std::cos(segment.alpha);
+  const double s = std::sin(segment.alpha);
+  segment.rho = mx * c + my * s;
+  segment.num_points = moments.n;
+
+  // Var(alpha) is noise over the spread of points along the line;
+  // rho = centroid . normal(alpha) picks up alpha error through the
+  // centroid's position along the line.
+  const double spread = n * (cxx * s * s + cyy * c * c - 2.0 * cxy * s * c);
+  const double sigma2 = sigma_m * sigma_m;
+  const double var_alpha = spread > 0 ? sigma2 / spread : M_PI * M_PI;
+  const double t = -mx * s + my * c;
+  segment.covariance << sigma2 / n + t * t * var_alpha, t * var_alpha,
+      t * var_alpha, var_alpha;
+
+  Canonicalize(segment);
+  const Eigen::Vector2d normal(std::cos(segment.alpha),
+                               std::sin(segment.alpha));
+  segment.start = first - (first.dot(normal) - segment.rho) * normal;
+  segment.end = last - (last.dot(normal) - segment.rho) * normal;
+  return segment;
+}
+
+LineSegment AlignNormal(const LineSegment& segment, double alpha) {
+  LineSegment result = segment;
+  if (std::abs(NormalizeAngle(segment.alpha - alpha)) > M_PI / 2) Flip(result);
+  return result;
+}
+
+LineSegment TransformSegment(const LineSegment& segment, const Pose2d& pose) {
+  LineSegment result = segment;
+  result.alpha = NormalizeAngle(segment.alpha + pose.theta);
+  const double k =
+      pose.x * std::cos(result.alpha) + pose.y * std::sin(result.alpha);
+  result.rho = segment.rho + k;
+  result.start = pose * segment.start;
+  result.end = pose * segment.end;
+  // Jacobian of (rho', alpha') with respect to (rho, alpha).
+  Eigen::Matrix2d jacobian;
+  jacobian << 1, -pose.x * std::sin(result.alpha) +
+                     pose.y * std::cos(result.alpha),
+      0, 1;
+  result.covariance = jacobian * segment.covariance * jacobian.transpose();
+  Canonicalize(result);
+  return result;
+}
+
+}  // namespace slam_dunk
@@ -0,0 +1,75 @@
+// Line segment features extracted from lidar scans.
+#ifndef SLAM_DUNK_LINE_FEATURES_LINE_SEGMENT_H_
+#define SLAM_DUNK_LINE_FEATURES_LINE_SEGMENT_H_
+#include <cstdint>
+#include <Eigen/Core>
+#include "scan_geometry.h"
+
+namespace slam_dunk {
+
+// Running sums of point coordinates. Enough to fit a line in O(1) and to
+// combine two fits by adding them up.
+struct LineMoments {
+  int32_t n = 0;
+  double sx = 0;
+  double sy = 0;
+  double sxx = 0;
+  double syy = 0;
+  double sxy = 0;
+
+  void Add(const Eigen::Vector2d& p) {
+    ++n;
+    sx += p.x();
+    sy += p.y();
+    sxx += p.x() * p.x();
+    syy += p.y() * p.y();
+    sxy += p.x() * p.y();
+  }
+
+  LineMoments& operator+=(const LineMoments& that);
+};
+
+// Line in Hessian normal form x * cos(alpha) + y * sin(alpha) = rho,
+// bounded by two end points.
+struct LineSegment {
+  // Distance from origin, always non-negative.
+  double rho = 0;
+  // Direction of the line normal in (-pi, pi].
+  double alpha = 0;
+  // End points projected onto the line.
+  Eigen::Vector2d start = Eigen::Vector2d::Zero();
+  Eigen::Vector2d end = Eigen::Vector2d::Zero();
+  // Covariance of (rho, alpha).
+  Eigen::Matrix2d covariance = Eigen::Matrix2d::Identity();
+  // Number of points supporting the segment.
+  int32_t num_points = 0;
+
+  double Length() const { return (end - start).norm(); }
+
+  // Unsigned distance from the infinite line to the point.
+  double DistanceTo(const Eigen::Vector2d& p) const;
+
+  // Position of the point along the line direction.
+  double Along(const Eigen::Vector2d& p) const;
+};
+
+// Wraps angle into (-pi, pi].
+double NormalizeAngle(double angle);
+
+// Total least squares fit of moments. Points are assumed to have isotropic
+// noise with `sigma_m` standard deviation, which is propagated into the
+// segment covariance. `first` and `last` become the end points.
+LineSegment FitLine(const LineMoments& moments, const Eigen::Vector2d& first,
+                    const Eigen::Vector2d& last, double sigma_m);
+
+// Returns the same segment with the normal flipped, if needed, to be within
+// pi/2 of `alpha`. Rho becomes negative when flipped. Lines passing near the
+// origin may otherwise compare as different because of the sign of rho.
+LineSegment AlignNormal(const LineSegment& segment, double alpha);
+
+// Returns segment expressed in the frame where `pose` is defined.
+LineSegment TransformSegment(const LineSegment& segment, const Pose2d& pose);
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_LINE_FEATURES_LINE_SEGMENT_H_
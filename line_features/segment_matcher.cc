@@ -0,0 +1,74 @@
+#include "line_features/segment_matcher.h"
+#include <cmath>
+#include <Eigen/Dense>
+#include "absl/strings/str_format.h"
+
+namespace slam_dunk {
+
+absl::StatusOr<SegmentMatch> SegmentMatcher::Match(
+    const std::vector<LineSegment>& scan, const LineMap& map,
+    const Pose2d& guess) const {
+  SegmentMatch result{.pose = guess};
+  // Pairs of scan segment and map segment indices.
+  std::vector<std::pair<size_t, int32_t>> pairs;
+  pairs.reserve(scan.size());
+
+  for (int32_t iteration = 0; iteration < options_.max_iterations;
+       ++iteration) {
+    pairs.clear();
+    for (size_t i = 0; i < scan.size(); ++i) {
+      const LineSegment in_map = TransformSegment(scan[i], result.pose);
+      if (const int32_t match = map.FindMatch(in_map, options_.rho_gate_m,
+                                              options_.alpha_gate_rad);
+          match >= 0) {
+        pairs.emplace_back(i, match);
+      }
+    }
+    result.num_matches = static_cast<int32_t>(pairs.size());
+    if (result.num_matches < options_.min_matches) {
+      return absl::NotFoundError(absl::StrFormat(
+          "Only %d segments matched the map", result.num_matches));
+    }
+
+    // Rotation about the lidar position shifts every alpha equally.
+    double weighted_angle = 0;
+    double total_weight = 0;
+    for (const auto& [i, index] : pairs) {
+      const double weight = scan[i].Length();
+      const LineSegment in_map = AlignNormal(
+          TransformSegment(scan[i], result.pose), map.segments()[index].alpha);
+      weighted_angle +=
+          weight * NormalizeAngle(map.segments()[index].alpha - in_map.alpha);
+      total_weight += weight;
+    }
+    const double d_theta = weighted_angle / total_weight;
+    result.pose.theta = NormalizeAngle(result.pose.theta + d_theta);
+
+    // Translation t moves each line by t . normal(alpha_map).
+    Eigen::Matrix2d normal_matrix = Eigen::Matrix2d::Zero();
+    Eigen::Vector2d rhs = Eigen::Vector2d::Zero();
+    for (const auto& [i, index] : pairs) {
+      const LineSegment& target = map.segments()[index];
+      const LineSegment in_map =
+          AlignNormal(TransformSegment(scan[i], result.pose), target.alpha);
+      const Eigen::Vector2d normal(std::cos(target.alpha),
+                                   std::sin(target.alpha));
+      const double weight = scan[i].Length();
+      normal_matrix += weight * normal * normal.transpose();
+      rhs += weight * normal * (target.rho - in_map.rho);
+    }
+    const Eigen::SelfAdjointEigenSolver<Eigen::Matrix2d> solver(normal_matrix);
+    if (solver.eigenvalues()(0) <
+        options_.min_conditioning * solver.eigenvalues()(1)) {
+      return absl::FailedPreconditionError(
+          "Matched segments do not constrain translation");
+    }
+    const Eigen::Vector2d t = normal_matrix.ldlt().solve(rhs);
+    result.pose.x += t.x();
+    result.pose.y += t.y();
+    if (t.norm() < 1e-4 && std::abs(d_theta) < 1e-5) break;
+  }
+  return result;
+}
+
+}  // namespace slam_dunk
@@ -0,0 +1,52 @@
+// Scan to map registration using line segments.
+#ifndef SLAM_DUNK_LINE_FEATURES_SEGMENT_MATCHER_H_
+#define SLAM_DUNK_LINE_FEATURES_SEGMENT_MATCHER_H_
+#include <cstdint>
+#include <vector>
+#include "absl/status/statusor.h"
+#include "line_features/line_map.h"
+#include "line_features/line_segment.h"
+#include "scan_geometry.h"
+
+namespace slam_dunk {
+
+// Result of aligning a scan with the map.
+struct SegmentMatch {
+  Pose2d pose;
+  // Number of scan segments associated with the map on the last iteration.
+  int32_t num_matches = 0;
+};
+
+// Aligns segments of a scan with a LineMap. Rotation is taken from the
+// length-weighted mean of normal angle differences, translation from
+// least squares on rho differences; both are iterated with fresh
+// associations.
+class SegmentMatcher {
+ public:
+  struct Options {
+    int32_t max_iterations = 10;
+    // Association gates, wide enough to cover the error of the guess.
+    double rho_gate_m = 0.4;
+    double alpha_gate_rad = 0.15;
+    // Minimum number of associations.
+    int32_t min_matches = 2;
+    // Translation is rejected if matched lines are nearly parallel:
+    // the smallest eigenvalue of the normal matrix over its largest.
+    double min_conditioning = 0.01;
+  };
+
+  SegmentMatcher() : SegmentMatcher(Options()) {}
+  explicit SegmentMatcher(const Options& options) : options_(options) {}
+
+  // Returns refined pose of the lidar in the map, starting from `guess`.
+  absl::StatusOr<SegmentMatch> Match(const std::vector<LineSegment>& scan,
+                                     const LineMap& map,
+                                     const Pose2d& guess) const;
+
+ private:
+  Options options_;
+};
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_LINE_FEATURES_SEGMENT_MATCHER_H_
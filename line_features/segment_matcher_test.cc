@@ -0,0 +1,72 @@
+#include "line_features/segment_matcher.h"
+#include "absl/status/status_matchers.h"
+#include "gmock/gmock-matchers.h"
+#include "gtest/gtest.h"
+#include "line_features/line_extractor.h"
+#include "line_features/line_map.h"
+#include "simulated_scan.h"
+
+namespace slam_dunk {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+using ::testing::DoubleNear;
+using ::testing::Ge;
+using ::testing::SizeIs;
+
+// Room with an inner wall so that the map is not just a rectangle.
+SimulatedWorld MakeWorld() {
+  SimulatedWorld world = SimulatedWorld::Room(8, 5);
+  world.walls.push_back({{5, 0}, {5, 2}});
+  return world;
+}
+
+TEST(LineMap, FusesRepeatedObservations) {
+  const SimulatedWorld world = MakeWorld();
+  LineExtractor extractor;
+  LineMap map;
+  const Pose2d pose{.x = 2, .y = 2.5};
+  for (uint32_t seed = 1; seed <= 10; ++seed) {
+    map.Insert(extractor.Extract(SimulateScan(world, pose, 2048,
+                                              /*range_sigma_m=*/0.01, seed)),
+               pose);
+  }
+  // Four outer walls and the visible face of the inner wall; the lower
+  // wall is split in two by the inner one.
+  EXPECT_THAT(map.segments().size(), Ge(5));
+  EXPECT_LE(map.segments().size(), 7);
+  // A 5 cm occupancy grid of the same room takes 160 x 100 cells.
+  EXPECT_LT(map.ByteSize(), 160 * 100 / 10);
+}
+
+TEST(SegmentMatcher, RecoversPose) {
+  const SimulatedWorld world = MakeWorld();
+  LineExtractor extractor;
+  LineMap map;
+  const Pose2d origin{.x = 2, .y = 2.5};
+  map.Insert(extractor.Extract(SimulateScan(world, origin, 4096, 0.005)),
+             origin);
+
+  const Pose2d truth{.x = 2.1, .y = 2.42, .theta = 0.03};
+  const auto scan = extractor.Extract(SimulateScan(world, truth, 4096, 0.005));
+  SegmentMatcher matcher;
+  auto match = matcher.Match(scan, map, origin);
+  ASSERT_THAT(match, IsOk()) << match.status();
+  EXPECT_THAT(match->pose.x, DoubleNear(truth.x, 0.02));
+  EXPECT_THAT(match->pose.y, DoubleNear(truth.y, 0.02));
+  EXPECT_THAT(match->pose.theta, DoubleNear(truth.theta, 0.005));
+}
+
+TEST(SegmentMatcher, FailsOnEmptyMap) {
+  const SimulatedWorld world = MakeWorld();
+  LineExtractor extractor;
+  const auto scan =
+      extractor.Extract(SimulateScan(world, Pose2d{.x = 2, .y = 2.5}, 2048));
+  SegmentMatcher matcher;
+  EXPECT_THAT(matcher.Match(scan, LineMap(), Pose2d()),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace slam_dunk
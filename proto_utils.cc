@@ -43,15 +43,39 @@ absl::Status SaveToFile(
 }
 
 absl::StatusOr<std::string> GetTextFromFile(absl::string_view file_path) {
-  std::ifstream file(file_path.data());
-  std::string data((std::istreambuf_iterator<char>(file)),
-                   std::istreambuf_iterator<char>());
-
-  if (data.empty()) {
-    return absl::InternalError("Failed to open data file " +
+  std::ifstream file(std::string(file_path), std::ios::binary | std::ios::ate);
+  if (!file) {
+    return absl::NotFoundError("Failed to open data file " +
+                               std::string(file_path));
+  }
+  std::string data(static_cast<size_t>(file.tellg()), '\0');
+  file.seekg(0);
+  file.read(data.data(), static_cast<std::streamsize>(data.size()));
+  if (!file) {
+    return absl::DataLossError("Failed to read data file " +
                                std::string(file_path));
   }
   return data;
 }
 
+absl::StatusOr<std::vector<slam_dunk::ScanResponse>>
+ConvertTextProtoStringToScanResponse(absl::string_view text) {
+  slam_dunk::proto::ScanResponse proto_response;
+  if (!google::protobuf::TextFormat::ParseFromString(std::string(text),
+                                                     &proto_response)) {
+    return absl::InvalidArgumentError("Failed in TextFormat::ParseFromString");
+  }
+  std::vector<slam_dunk::ScanResponse> scan_response;
+  scan_response.reserve(proto_response.items_size());
+  for (const auto& item : proto_response.items()) {
+    scan_response.push_back(slam_dunk::ScanResponse{
+        .theta = static_cast<uint16_t>(item.theta()),
+        .distance_mm = item.distance_mm(),
+        .quality = static_cast<uint8_t>(item.quality()),
+        .flag = static_cast<uint8_t>(item.flag()),
+    });
+  }
+  return scan_response;
+}
+
 }  // namespace slam_dunk
@@ -15,8 +15,13 @@ absl::Status SaveToFile(
     const std::vector<slam_dunk::ScanResponse>& scan_response,
     absl::string_view file_path);
 
+// Reads the whole file, e.g. to split and parse it in chunks.
 absl::StatusOr<std::string> GetTextFromFile(absl::string_view file_path);
 
+// Parses text proto produced by SaveToFile.
+absl::StatusOr<std::vector<slam_dunk::ScanResponse>>
+ConvertTextProtoStringToScanResponse(absl::string_view text);
+
 }  // namespace slam_dunk
 
 #endif  // SLAM_DUNK__PROTO_UTILS_H_
@@ -13,6 +13,7 @@ namespace {
 
 using ::absl_testing::IsOk;
 using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
 using ::bazel::tools::cpp::runfiles::Runfiles;
 using ::protobuf_matchers::EqualsProto;
 using ::testing::HasSubstr;
@@ -50,5 +51,26 @@ TEST(SaveAndGetFile, Works) {
   EXPECT_THAT(GetTextFromFile(test_file), IsOkAndHolds(HasSubstr("items")));
 }
 
+TEST(GetTextFromFile, MissingFile) {
+  EXPECT_THAT(GetTextFromFile("/nonexistent/lidar.txtpb"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(ConvertTextProtoStringToScanResponse, RoundTrip) {
+  const std::vector<ScanResponse> scan = {
+      ScanResponse{.theta = 5566, .distance_mm = 2257, .quality = 60},
+      ScanResponse{.theta = 5822, .distance_mm = 2243, .quality = 60,
+                   .flag = 1}};
+  auto text = ConvertScanResponseToTextProtoString(scan);
+  ASSERT_THAT(text, IsOk());
+  auto parsed = ConvertTextProtoStringToScanResponse(text.value());
+  ASSERT_THAT(parsed, IsOk());
+  ASSERT_EQ(parsed->size(), 2);
+  EXPECT_EQ((*parsed)[1].theta, 5822);
+  EXPECT_EQ((*parsed)[1].distance_mm, 2243);
+  EXPECT_EQ((*parsed)[1].quality, 60);
+  EXPECT_EQ((*parsed)[1].flag, 1);
+}
+
 }  // namespace
 }  // namespace slam_dunk
@@ -0,0 +1,137 @@
+#include "range_image/range_image.h"
+#include <algorithm>
+#include <bit>
+#include "absl/strings/str_format.h"
+
+namespace slam_dunk {
+namespace {
+
+// One loop per policy, so that the combine is inlined and vectorised.
+template <typename Combine>
+void MergeBins(uint32_t* a, const uint32_t* b, int32_t n, Combine combine) {
+  for (int32_t i = 0; i < n; ++i) {
+    // Keep whichever side has a return when the other does not.
+    const uint32_t merged = combine(a[i], b[i]);
+    a[i] = a[i] == 0 ? b[i] : (b[i] == 0 ? a[i] : merged);
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<RangeImage> RangeImage::Create(int32_t num_bins,
+                                              BinPolicy policy) {
+  if (num_bins < 1 || num_bins > (1 << 16)) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Number of bins must be in [1, 65536]: %d", num_bins));
+  }
+  return RangeImage(num_bins, policy);
+}
+
+RangeImage::RangeImage(int32_t num_bins, BinPolicy policy)
+    : num_bins_(num_bins),
+      policy_(policy),
+      range_(num_bins, 0),
+      valid_((num_bins + 63) / 64, 0),
+      count_(policy == BinPolicy::kMean ? num_bins : 0, 0) {}
+
+void RangeImage::Build(const std::vector<ScanResponse>& scan) {
+  std::fill(range_.begin(), range_.end(), 0);
+  uint32_t* range = range_.data();
+  const uint32_t num_bins = num_bins_;
+  switch (policy_) {
+    case BinPolicy::kMin:
+      // Zero is no return, so 0 - 1 wraps and loses every comparison.
+      for (const auto& response : scan) {
+        const uint32_t bin = (uint32_t{response.theta} * num_bins) >> 16;
+        const uint32_t d = response.distance_mm;
+        range[bin] = d - 1 < range[bin] - 1 ? d : range[bin];
+      }
+      break;
+    case BinPolicy::kLast:
+      for (const auto& response : scan) {
+        const uint32_t bin = (uint32_t{response.theta} * num_bins) >> 16;
+        const uint32_t d = response.distance_mm;
+        range[bin] = d != 0 ? d : range[bin];
+      }
+      break;
+    case BinPolicy::kMean: {
+      std::fill(count_.begin(), count_.end(), 0);
+      uint32_t* count = count_.data();
+      for (const auto& response : scan) {
+        const uint32_t bin = (uint32_t{response.theta} * num_bins) >> 16;
+        range[bin] += response.distance_mm;
+        count[bin] += response.distance_mm != 0;
+      }
+      for (uint32_t i = 0; i < num_bins; ++i) {
+        range[i] = count[i] ? (range[i] + count[i] / 2) / count[i] : 0;
+      }
+      break;
+    }
+  }
+
+  // Validity mask, 64 bins at a time.
+  const int32_t words = static_cast<int32_t>(valid_.size());
+  for (int32_t w = 0; w < words; ++w) {
+    const int32_t end = std::min(num_bins_, (w + 1) * 64);
+    uint64_t word = 0;
+    for (int32_t i = w * 64; i < end; ++i) {
+      word |= uint64_t{range[i] != 0} << (i & 63);
+    }
+    valid_[w] = word;
+  }
+}
+
+int32_t RangeImage::CountValid() const {
+  int32_t count = 0;
+  for (uint64_t word : valid_) count += std::popcount(word);
+  return count;
+}
+
+int32_t RangeImage::Diff(const RangeImage& other, uint32_t threshold_q2,
+                         std::vector<uint64_t>& changed) const {
+  changed.assign(valid_.size(), 0);
+  const uint32_t* a = range_.data();
+  const uint32_t* b = other.range_.data();
+  int32_t count = 0;
+  const int32_t words = static_cast<int32_t>(valid_.size());
+  for (int32_t w = 0; w < words; ++w) {
+    // A bin without return has zero range, so validity changes show up as
+    // large deltas too; the xor covers thresholds above the range itself.
+    uint64_t word = valid_[w] ^ other.valid_[w];
+    const int32_t end = std::min(num_bins_, (w + 1) * 64);
+    for (int32_t i = w * 64; i < end; ++i) {
+      const uint32_t delta = a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+      word |= uint64_t{delta > threshold_q2} << (i & 63);
+    }
+    changed[w] = word;
+    count += std::popcount(word);
+  }
+  return count;
+}
+
+absl::Status RangeImage::Merge(const RangeImage& other) {
+  if (other.num_bins_ != num_bins_) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Cannot merge image of %d bins into %d bins",
+                        other.num_bins_, num_bins_));
+  }
+  uint32_t* a = range_.data();
+  const uint32_t* b = other.range_.data();
+  switch (policy_) {
+    case BinPolicy::kMin:
+      MergeBins(a, b, num_bins_,
+                [](uint32_t x, uint32_t y) { return std::min(x, y); });
+      break;
+    case BinPolicy::kLast:
+      MergeBins(a, b, num_bins_, [](uint32_t, uint32_t y) { return y; });
+      break;
+    case BinPolicy::kMean:
+      MergeBins(a, b, num_bins_,
+                [](uint32_t x, uint32_t y) { return (x + y + 1) / 2; });
+      break;
+  }
+  for (size_t w = 0; w < valid_.size(); ++w) valid_[w] |= other.valid_[w];
+  return absl::OkStatus();
+}
+
+}  // namespace slam_dunk
@@ -0,0 +1,126 @@
+// Fixed-angle range image of one lidar revolution.
+#ifndef SLAM_DUNK_RANGE_IMAGE_RANGE_IMAGE_H_
+#define SLAM_DUNK_RANGE_IMAGE_RANGE_IMAGE_H_
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "lidar.h"
+
+namespace slam_dunk {
+
+inline constexpr size_t kCacheLineSize = 64;
+
+// Allocates storage on cache line boundaries.
+template <typename T>
+struct CacheAlignedAllocator {
+  using value_type = T;
+
+  CacheAlignedAllocator() = default;
+  template <typename U>
+  CacheAlignedAllocator(const CacheAlignedAllocator<U>&) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(
+        ::operator new(n * sizeof(T), std::align_val_t{kCacheLineSize}));
+  }
+  void deallocate(T* p, size_t) {
+    ::operator delete(p, std::align_val_t{kCacheLineSize});
+  }
+
+  template <typename U>
+  bool operator==(const CacheAlignedAllocator<U>&) const {
+    return true;
+  }
+};
+
+template <typename T>
+using CacheAlignedVector = std::vector<T, CacheAlignedAllocator<T>>;
+
+// How samples falling into the same bin are combined.
+enum class BinPolicy {
+  // Closest return, conservative for obstacle checks.
+  kMin,
+  // Latest sample in scan order.
+  kLast,
+  // Average of the samples.
+  kMean,
+};
+
+// Revolution resampled into a constant number of angular bins, so that
+// "range at bearing theta" is an array lookup instead of a binary search
+// over Lidar::Scan output. Bins are computed with integer math directly
+// from the q14 theta; ranges stay in q2 millimeters.
+class RangeImage {
+ public:
+  // `num_bins` is between 1 and 65536, e.g. 720, 1440 or 2880.
+  static absl::StatusOr<RangeImage> Create(int32_t num_bins,
+                                           BinPolicy policy = BinPolicy::kMin);
+
+  // Replaces content with the revolution in one pass over the samples.
+  // Samples with zero distance do not make a bin valid.
+  void Build(const std::vector<ScanResponse>& scan);
+
+  int32_t num_bins() const { return num_bins_; }
+  BinPolicy policy() const { return policy_; }
+
+  // Returns bin of the q14 angle.
+  int32_t BinOf(uint16_t theta) const {
+    return static_cast<int32_t>((uint32_t{theta} * num_bins_) >> 16);
+  }
+
+  // Returns q14 angle of the bin center.
+  uint16_t ThetaOf(int32_t bin) const {
+    // 64 bits, the shifted value overflows 32 bits from bin 32768 on.
+    return static_cast<uint16_t>(((uint64_t{2} * bin + 1) << 16) /
+                                 (uint64_t{2} * num_bins_));
+  }
+
+  bool valid(int32_t bin) const {
+    return (valid_[bin >> 6] >> (bin & 63)) & 1;
+  }
+
+  // Range of the bin in q2 millimeters, zero if not valid.
+  uint32_t range(int32_t bin) const { return range_[bin]; }
+
+  // Range at bearing in q2 millimeters, zero if there is no return.
+  uint32_t RangeAt(uint16_t theta) const { return range_[BinOf(theta)]; }
+
+  // Number of valid bins.
+  int32_t CountValid() const;
+
+  // Marks bins that differ from `other`: valid in only one image, or valid
+  // in both with ranges further apart than `threshold_q2`. `changed` is a
+  // bitmask in the same layout as the validity mask. Returns the number of
+  // changed bins. Images must have the same number of bins.
+  int32_t Diff(const RangeImage& other, uint32_t threshold_q2,
+               std::vector<uint64_t>& changed) const;
+
+  // Folds `other` into this image, e.g. the next revolution. Bins valid in
+  // both are combined with this image's policy; kMean averages the two
+  // images. Bins valid only in `other` are copied. Fails if the images
+  // have different numbers of bins.
+  absl::Status Merge(const RangeImage& other);
+
+  // Ranges of all bins, aligned to a cache line.
+  const uint32_t* data() const { return range_.data(); }
+
+  // Validity bitmask, bin i is bit (i % 64) of word i / 64.
+  const std::vector<uint64_t>& valid_mask() const { return valid_; }
+
+ private:
+  RangeImage(int32_t num_bins, BinPolicy policy);
+
+  int32_t num_bins_;
+  BinPolicy policy_;
+  CacheAlignedVector<uint32_t> range_;
+  std::vector<uint64_t> valid_;
+  // Scratch for kMean, kept to avoid allocations per revolution.
+  CacheAlignedVector<uint32_t> count_;
+};
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_RANGE_IMAGE_RANGE_IMAGE_H_
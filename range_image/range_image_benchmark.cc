@@ -0,0 +1,86 @@
+// Range image construction and lookups against the sorted scan.
+// blaze run -c opt //range_image:range_image_benchmark
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include "range_image/range_image.h"
+#include "simulated_scan.h"
+
+namespace slam_dunk {
+namespace {
+
+std::vector<ScanResponse> MakeScan() {
+  SimulatedWorld world = SimulatedWorld::Room(12, 8);
+  world.circles.push_back({{3, 3}, 0.3});
+  return SimulateScan(world, Pose2d{.x = 4, .y = 5}, 8192, 0.01);
+}
+
+void BM_Build(benchmark::State& state) {
+  const auto scan = MakeScan();
+  auto image = RangeImage::Create(state.range(0),
+                                  static_cast<BinPolicy>(state.range(1)));
+  for (auto _ : state) {
+    image->Build(scan);
+    benchmark::DoNotOptimize(image->data());
+  }
+  state.SetItemsProcessed(state.iterations() * scan.size());
+}
+BENCHMARK(BM_Build)->ArgsProduct(
+    {{720, 1440, 2880},
+     {static_cast<int>(BinPolicy::kMin), static_cast<int>(BinPolicy::kLast),
+      static_cast<int>(BinPolicy::kMean)}});
+
+void BM_RangeAt(benchmark::State& state) {
+  auto image = RangeImage::Create(2880);
+  image->Build(MakeScan());
+  uint16_t theta = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(image->RangeAt(theta));
+    theta += 7919;
+  }
+}
+BENCHMARK(BM_RangeAt);
+
+// What callers did before: binary search over Lidar::Scan output.
+void BM_BinarySearch(benchmark::State& state) {
+  const auto scan = MakeScan();
+  uint16_t theta = 0;
+  for (auto _ : state) {
+    auto it = std::lower_bound(scan.begin(), scan.end(),
+                               ScanResponse{.theta = theta});
+    benchmark::DoNotOptimize(it);
+    theta += 7919;
+  }
+}
+BENCHMARK(BM_BinarySearch);
+
+void BM_Diff(benchmark::State& state) {
+  const auto scan = MakeScan();
+  auto a = RangeImage::Create(state.range(0));
+  auto b = RangeImage::Create(state.range(0));
+  a->Build(scan);
+  b->Build(SimulateScan(SimulatedWorld::Room(12, 8), Pose2d{.x = 4, .y = 5},
+                        8192, 0.01));
+  std::vector<uint64_t> changed;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a->Diff(*b, 200, changed));
+  }
+}
+BENCHMARK(BM_Diff)->Arg(720)->Arg(2880);
+
+void BM_Merge(benchmark::State& state) {
+  const auto scan = MakeScan();
+  auto a = RangeImage::Create(state.range(0));
+  auto b = RangeImage::Create(state.range(0));
+  a->Build(scan);
+  b->Build(scan);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a->Merge(*b));
+    benchmark::DoNotOptimize(a->data());
+  }
+}
+BENCHMARK(BM_Merge)->Arg(720)->Arg(2880);
+
+}  // namespace
+}  // namespace slam_dunk
+
+BENCHMARK_MAIN();
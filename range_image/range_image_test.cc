@@ -0,0 +1,147 @@
+#include "range_image/range_image.h"
+#include <algorithm>
+#include "absl/status/status_matchers.h"
+#include "gmock/gmock-matchers.h"
+#include "gtest/gtest.h"
+#include "simulated_scan.h"
+
+namespace slam_dunk {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+
+RangeImage MakeImage(int32_t num_bins, BinPolicy policy) {
+  auto image = RangeImage::Create(num_bins, policy);
+  EXPECT_THAT(image, IsOk());
+  return *std::move(image);
+}
+
+TEST(RangeImage, RejectsBadNumberOfBins) {
+  EXPECT_THAT(RangeImage::Create(0),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(RangeImage::Create(70000),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(RangeImage, BinsFollowTheta) {
+  RangeImage image = MakeImage(720, BinPolicy::kMin);
+  EXPECT_EQ(image.BinOf(0), 0);
+  // 90 degrees.
+  EXPECT_EQ(image.BinOf(1 << 14), 180);
+  EXPECT_EQ(image.BinOf(0xFFFF), 719);
+  for (int32_t bin = 0; bin < image.num_bins(); ++bin) {
+    EXPECT_EQ(image.BinOf(image.ThetaOf(bin)), bin);
+  }
+}
+
+TEST(RangeImage, Policies) {
+  // Three samples in bin 0 of a 4-bin image, one empty.
+  const std::vector<ScanResponse> scan = {
+      {.theta = 10, .distance_mm = 400},
+      {.theta = 20, .distance_mm = 0},
+      {.theta = 30, .distance_mm = 200},
+      {.theta = 40, .distance_mm = 600},
+      {.theta = 1 << 15, .distance_mm = 1000},
+  };
+  RangeImage min_image = MakeImage(4, BinPolicy::kMin);
+  min_image.Build(scan);
+  EXPECT_EQ(min_image.range(0), 200);
+  RangeImage last_image = MakeImage(4, BinPolicy::kLast);
+  last_image.Build(scan);
+  EXPECT_EQ(last_image.range(0), 600);
+  RangeImage mean_image = MakeImage(4, BinPolicy::kMean);
+  mean_image.Build(scan);
+  EXPECT_EQ(mean_image.range(0), 400);
+
+  for (const RangeImage* image : {&min_image, &last_image, &mean_image}) {
+    EXPECT_TRUE(image->valid(0));
+    EXPECT_FALSE(image->valid(1));
+    EXPECT_TRUE(image->valid(2));
+    EXPECT_EQ(image->range(2), 1000);
+    EXPECT_FALSE(image->valid(3));
+    EXPECT_EQ(image->CountValid(), 2);
+  }
+}
+
+TEST(RangeImage, RangeAtMatchesClosestSample) {
+  const auto scan = SimulateScan(SimulatedWorld::Room(6, 4),
+                                 Pose2d{.x = 2, .y = 1}, /*count=*/2048);
+  // One sample per bin.
+  RangeImage image = MakeImage(2048, BinPolicy::kMin);
+  image.Build(scan);
+  EXPECT_EQ(image.CountValid(), 2048);
+  for (const auto& response : scan) {
+    EXPECT_EQ(image.RangeAt(response.theta), response.distance_mm);
+  }
+}
+
+TEST(RangeImage, DiffFindsChangedBins) {
+  const SimulatedWorld room = SimulatedWorld::Room(6, 4);
+  SimulatedWorld with_box = room;
+  with_box.circles.push_back({{4, 1}, 0.3});
+  const Pose2d pose{.x = 2, .y = 1};
+  RangeImage before = MakeImage(720, BinPolicy::kMin);
+  before.Build(SimulateScan(room, pose, 2880));
+  RangeImage after = MakeImage(720, BinPolicy::kMin);
+  after.Build(SimulateScan(with_box, pose, 2880));
+
+  std::vector<uint64_t> changed;
+  EXPECT_EQ(before.Diff(before, 0, changed), 0);
+  const int32_t count = after.Diff(before, /*threshold_q2=*/100 * 4, changed);
+  // Circle of 0.3 m at 2 m covers about 17 degrees straight ahead.
+  EXPECT_GT(count, 25);
+  EXPECT_LT(count, 40);
+  EXPECT_TRUE(changed[0] & 1);
+  EXPECT_FALSE(changed[180 / 64] & (uint64_t{1} << (180 % 64)));
+}
+
+TEST(RangeImage, DiffCountsValidityChange) {
+  RangeImage a = MakeImage(128, BinPolicy::kMin);
+  RangeImage b = MakeImage(128, BinPolicy::kMin);
+  a.Build({{.theta = 0, .distance_mm = 100}});
+  std::vector<uint64_t> changed;
+  EXPECT_EQ(a.Diff(b, 1000, changed), 1);
+  EXPECT_EQ(changed[0], 1);
+  EXPECT_EQ(changed[1], 0);
+}
+
+TEST(RangeImage, Merge) {
+  RangeImage a = MakeImage(4, BinPolicy::kMin);
+  RangeImage b = MakeImage(4, BinPolicy::kMin);
+  a.Build({{.theta = 0, .distance_mm = 300},
+           {.theta = 1 << 14, .distance_mm = 500}});
+  b.Build({{.theta = 0, .distance_mm = 100},
+           {.theta = 1 << 15, .distance_mm = 700}});
+  ASSERT_THAT(a.Merge(b), IsOk());
+  EXPECT_EQ(a.range(0), 100);
+  EXPECT_EQ(a.range(1), 500);
+  EXPECT_EQ(a.range(2), 700);
+  EXPECT_FALSE(a.valid(3));
+  EXPECT_EQ(a.CountValid(), 3);
+}
+
+TEST(RangeImage, MergeRejectsDifferentNumberOfBins) {
+  RangeImage a = MakeImage(4, BinPolicy::kMin);
+  RangeImage b = MakeImage(8, BinPolicy::kMin);
+  EXPECT_THAT(a.Merge(b), StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(RangeImage, ThetaOfFinestImage) {
+  RangeImage image = MakeImage(1 << 16, BinPolicy::kMin);
+  // Centers are half a q14 unit past the bin start, rounded down.
+  EXPECT_EQ(image.ThetaOf(0), 0);
+  EXPECT_EQ(image.ThetaOf(32768), 32768);
+  EXPECT_EQ(image.ThetaOf(65535), 65535);
+  for (int32_t bin = 0; bin < image.num_bins(); ++bin) {
+    ASSERT_EQ(image.BinOf(image.ThetaOf(bin)), bin);
+  }
+}
+
+TEST(RangeImage, StorageIsCacheAligned) {
+  RangeImage image = MakeImage(2880, BinPolicy::kMin);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(image.data()) % kCacheLineSize, 0);
+}
+
+}  // namespace
+}  // namespace slam_dunk
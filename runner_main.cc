@@ -3,6 +3,9 @@
 // Show real-time lidar data
 // blaze run //:runner_main -- --usb_port=/dev/ttyUSB0 --visualizer_port=9000
 //
+// Find the lidar on any /dev/ttyUSB* port and baud rate
+// blaze run //:runner_main -- --usb_port=auto --visualizer_port=9000
+//
 // Show saved lidar data
 // blaze run //:runner_main -- in_path=testdata/lidar.txtpb
 // --visualizer_port=9000
@@ -10,26 +13,46 @@
 // Run lidar and save data in the text proto format
 // blaze run //:runner_main -- --usb_port=/dev/ttyUSB0
 // --out_path=/tmp/lidar.txtpb
+//
+// Publish real-time lidar data to local processes through shared memory
+// blaze run //:runner_main -- --usb_port=/dev/ttyUSB0
+// --shm_name=/slam_dunk_lidar
 
+#include <csignal>
 #include <fstream>
 #include <iostream>
 #include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
 #include "gflags/gflags.h"
 #include "glog/logging.h"
 #include "lidar.h"
+#include "lidar_discovery.h"
 #include "proto/lidar_response.pb.h"
 #include "proto_utils.h"
+#include "runtime/event_loop.h"
+#include "runtime/scan_source.h"
+#include "shm/shm_publisher.h"
 #include "status_macros.h"
 #include "visualizer_client.h"
 
-ABSL_FLAG(std::string, usb_port, "", "USB port");
+ABSL_FLAG(std::string, usb_port, "",
+          "USB port, or \"auto\" to probe /dev/ttyUSB* at all baud rates.");
+ABSL_FLAG(std::string, lidar_cache, "/tmp/slam_dunk_lidar.cache",
+          "Where --usb_port=auto remembers the port, baud rate and scan "
+          "mode of each lidar.");
 ABSL_FLAG(int32_t, visualizer_port, 0, "UDP port to connect to the visualizer");
 ABSL_FLAG(std::string, out_path, "", "Lidar response data in proto format.");
 ABSL_FLAG(std::string, in_path, "",
           "Input path for the file in text proto format.");
 ABSL_FLAG(int32_t, baud_rate, 115200, "Default baud rate for A1");
+ABSL_FLAG(absl::Duration, heartbeat, absl::Seconds(10),
+          "How often to log the number of revolutions while streaming.");
+ABSL_FLAG(std::string, shm_name, "",
+          "Shared memory segment to publish revolutions to, e.g. "
+          "/slam_dunk_lidar. Read it with shm/shm_reader.h.");
 
 // Gets one scan and saves response into file with
 // text proto format.
@@ -50,16 +73,42 @@ absl::Status VisualizeFromFile(slam_dunk::VisualizerClient& client) {
   return absl::OkStatus();
 }
 
+// Streams revolutions to the visualizer and/or shared memory until
+// SIGINT/SIGTERM.
 absl::Status ShowRealTimeData(slam_dunk::Lidar& lidar,
                               slam_dunk::VisualizerClient& client) {
-  while (1) {
-    auto scan_data = lidar.Scan();
-    if (!scan_data.ok()) return scan_data.status();
-    ASSIGN_OR_RETURN(auto data,
-                     ConvertScanResponseToTextProtoString(scan_data.value()));
-    if (auto result = client.SendData(data); !result.has_value())
-      return absl::InternalError("Failed to send data to visualizer");
+  ASSIGN_OR_RETURN(auto loop, slam_dunk::EventLoop::Create());
+  // Before the scanning thread starts, so that it inherits the signal mask.
+  RETURN_IF_ERROR(loop->StopOnSignals({SIGINT, SIGTERM}));
+
+  slam_dunk::ScanSource source(*loop, [&lidar] { return lidar.Scan(); });
+  if (absl::GetFlag(FLAGS_visualizer_port) != 0) {
+    source.AddSink([&client](const std::vector<slam_dunk::ScanResponse>& scan)
+                       -> absl::Status {
+      ASSIGN_OR_RETURN(auto data, ConvertScanResponseToTextProtoString(scan));
+      if (auto result = client.SendData(data); !result.has_value())
+        return absl::InternalError("Failed to send data to visualizer");
+      return absl::OkStatus();
+    });
+  }
+  std::unique_ptr<slam_dunk::ShmPublisher> publisher;
+  if (!absl::GetFlag(FLAGS_shm_name).empty()) {
+    ASSIGN_OR_RETURN(publisher, slam_dunk::ShmPublisher::Create(
+                                    absl::GetFlag(FLAGS_shm_name)));
+    source.AddSink(
+        [&publisher](const std::vector<slam_dunk::ScanResponse>& scan) {
+          return publisher->Publish(scan);
+        });
   }
+  auto heartbeat =
+      loop->AddPeriodic(absl::GetFlag(FLAGS_heartbeat), [&source] {
+        LOG(INFO) << "Revolutions: " << source.revolutions()
+                  << ", dropped: " << source.dropped();
+        return absl::OkStatus();
+      });
+  RETURN_IF_ERROR(heartbeat.status());
+  source.Start();
+  return loop->Run();
 }
 
 int main(int argc, char** argv) {
@@ -85,26 +134,55 @@ int main(int argc, char** argv) {
   // From lidar to either visualization or saving data
   if (!absl::GetFlag(FLAGS_usb_port).empty() &&
       (!absl::GetFlag(FLAGS_out_path).empty() ||
-       absl::GetFlag(FLAGS_visualizer_port) != 0)) {
-    auto lidar_status = Lidar::Create(absl::GetFlag(FLAGS_usb_port),
-                                      absl::GetFlag(FLAGS_baud_rate));
+       absl::GetFlag(FLAGS_visualizer_port) != 0 ||
+       !absl::GetFlag(FLAGS_shm_name).empty())) {
+    // Streaming stops on these signals. They are blocked before the SDK and
+    // discovery start threads, so that none of those takes them with the
+    // default action and only the event loop sees them.
+    if (absl::GetFlag(FLAGS_visualizer_port) != 0 ||
+        !absl::GetFlag(FLAGS_shm_name).empty()) {
+      if (auto block_status = slam_dunk::BlockSignals({SIGINT, SIGTERM});
+          !block_status.ok()) {
+        LOG(ERROR) << block_status.message();
+        return EXIT_FAILURE;
+      }
+    }
+    absl::StatusOr<std::unique_ptr<Lidar>> lidar_status;
+    if (absl::GetFlag(FLAGS_usb_port) == "auto") {
+      slam_dunk::LidarDiscovery::Options options;
+      options.cache_path = absl::GetFlag(FLAGS_lidar_cache);
+      slam_dunk::LidarDiscovery discovery(options);
+      lidar_status = discovery.Discover();
+      if (lidar_status.ok()) {
+        LOG(INFO) << absl::StreamFormat(
+            "Found lidar on %s at %d baud, scan mode %d",
+            discovery.config().usb_port, discovery.config().baud_rate,
+            discovery.config().scan_mode);
+      }
+    } else {
+      lidar_status = Lidar::Create(absl::GetFlag(FLAGS_usb_port),
+                                   absl::GetFlag(FLAGS_baud_rate));
+    }
     if (!lidar_status.ok()) {
       LOG(ERROR) << lidar_status.status();
       return EXIT_FAILURE;
     }
     const auto& lidar = lidar_status.value();
 
-    if (const auto result = lidar->Scan(); !result.ok()) {
-      LOG(ERROR) << result.status();
+    if (const auto ready = lidar->WaitForFirstRevolution(); !ready.ok()) {
+      LOG(ERROR) << ready.status();
       return EXIT_FAILURE;
+    } else {
+      LOG(INFO) << "First revolution after " << *ready;
     }
     auto [model, firmware, hardware, serial_number] = lidar->GetDeviceInfo();
     LOG(INFO) << absl::StreamFormat(
         "Model: %s Firmware: %s Hardware: %s Serial: %s", model, firmware,
         hardware, serial_number);
 
-    // Show real-time data
-    if (absl::GetFlag(FLAGS_visualizer_port) != 0) {
+    // Show or publish real-time data
+    if (absl::GetFlag(FLAGS_visualizer_port) != 0 ||
+        !absl::GetFlag(FLAGS_shm_name).empty()) {
       if (auto show_status = ShowRealTimeData(*lidar.get(), *client->get());
           !show_status.ok()) {
         LOG(ERROR) << show_status.message();
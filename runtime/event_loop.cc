@@ -0,0 +1,243 @@
+#include "runtime/event_loop.h"
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include "absl/memory/memory.h"
+#include "absl/strings/str_format.h"
+
+namespace slam_dunk {
+namespace {
+
+constexpr int32_t kMaxEvents = 16;
+
+absl::Status ErrnoError(absl::string_view what) {
+  return absl::InternalError(
+      absl::StrFormat("%s failed: %s", what, strerror(errno)));
+}
+
+sigset_t MaskOf(std::initializer_list<int> signals) {
+  sigset_t mask;
+  sigemptyset(&mask);
+  for (int signal : signals) sigaddset(&mask, signal);
+  return mask;
+}
+
+}  // namespace
+
+absl::Status BlockSignals(std::initializer_list<int> signals) {
+  const sigset_t mask = MaskOf(signals);
+  if (pthread_sigmask(SIG_BLOCK, &mask, nullptr) != 0) {
+    return absl::InternalError("pthread_sigmask failed");
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<EventLoop>> EventLoop::Create() {
+  const int32_t epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd < 0) return ErrnoError("epoll_create1");
+  const int32_t wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wake_fd < 0) {
+    close(epoll_fd);
+    return ErrnoError("eventfd");
+  }
+  auto loop = absl::WrapUnique(new EventLoop(epoll_fd, wake_fd));
+  if (auto status = loop->Register(wake_fd, Kind::kWake, nullptr);
+      !status.ok()) {
+    return status;
+  }
+  return loop;
+}
+
+EventLoop::EventLoop(int32_t epoll_fd, int32_t wake_fd)
+    : epoll_fd_(epoll_fd), wake_fd_(wake_fd) {}
+
+EventLoop::~EventLoop() {
+  for (const auto& [fd, handler] : handlers_) {
+    // Readers are owned by the caller.
+    if (handler.kind == Kind::kTimer) close(fd);
+  }
+  if (signal_fd_ >= 0) {
+    // Signals that arrived after the loop stopped are consumed here, they
+    // would otherwise take the default action once unblocked.
+    signalfd_siginfo info;
+    while (read(signal_fd_, &info, sizeof(info)) == sizeof(info)) {
+    }
+    close(signal_fd_);
+    pthread_sigmask(SIG_SETMASK, &previous_mask_, nullptr);
+  }
+  close(wake_fd_);
+  close(epoll_fd_);
+}
+
+absl::Status EventLoop::Register(int32_t fd, Kind kind, Callback callback) {
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+    return ErrnoError("epoll_ctl");
+  }
+  handlers_[fd] = Handler{.kind = kind, .callback = std::move(callback)};
+  return absl::OkStatus();
+}
+
+absl::Status EventLoop::AddReader(int32_t fd, Callback callback) {
+  return Register(fd, Kind::kReader, std::move(callback));
+}
+
+absl::Status EventLoop::RemoveReader(int32_t fd) {
+  auto it = handlers_.find(fd);
+  if (it == handlers_.end() || it->second.kind != Kind::kReader) {
+    return absl::NotFoundError(absl::StrFormat("No reader for fd %d", fd));
+  }
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+  handlers_.erase(it);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<int32_t> EventLoop::AddPeriodic(absl::Duration period,
+                                               Callback callback) {
+  if (period <= absl::ZeroDuration()) {
+    return absl::InvalidArgumentError("Period must be positive");
+  }
+  const int32_t fd =
+      timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (fd < 0) return ErrnoError("timerfd_create");
+  itimerspec spec{};
+  spec.it_interval = absl::ToTimespec(period);
+  spec.it_value = spec.it_interval;
+  if (timerfd_settime(fd, 0, &spec, nullptr) < 0) {
+    close(fd);
+    return ErrnoError("timerfd_settime");
+  }
+  if (auto status = Register(fd, Kind::kTimer, std::move(callback));
+      !status.ok()) {
+    close(fd);
+    return status;
+  }
+  return fd;
+}
+
+absl::Status EventLoop::RemovePeriodic(int32_t id) {
+  auto it = handlers_.find(id);
+  if (it == handlers_.end() || it->second.kind != Kind::kTimer) {
+    return absl::NotFoundError(absl::StrFormat("No periodic task %d", id));
+  }
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, id, nullptr);
+  close(id);
+  handlers_.erase(it);
+  return absl::OkStatus();
+}
+
+absl::Status EventLoop::StopOnSignals(std::initializer_list<int> signals) {
+  if (signal_fd_ >= 0) {
+    return absl::FailedPreconditionError("Signals are already handled");
+  }
+  const sigset_t mask = MaskOf(signals);
+  if (pthread_sigmask(SIG_BLOCK, &mask, &previous_mask_) != 0) {
+    return absl::InternalError("pthread_sigmask failed");
+  }
+  signal_fd_ = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+  if (signal_fd_ < 0) {
+    const absl::Status status = ErrnoError("signalfd");
+    pthread_sigmask(SIG_SETMASK, &previous_mask_, nullptr);
+    return status;
+  }
+  return Register(signal_fd_, Kind::kSignal, nullptr);
+}
+
+int32_t EventLoop::OnShutdown(std::function<void()> hook) {
+  shutdown_hooks_.emplace_back(next_hook_id_, std::move(hook));
+  return next_hook_id_++;
+}
+
+void EventLoop::RemoveShutdownHook(int32_t id) {
+  std::erase_if(shutdown_hooks_,
+                [id](const auto& hook) { return hook.first == id; });
+}
+
+void EventLoop::Post(Callback callback) {
+  {
+    absl::MutexLock lock(&mutex_);
+    posted_.push_back(std::move(callback));
+  }
+  const uint64_t one = 1;
+  // Can only fail if the counter overflows, which still wakes the loop.
+  (void)write(wake_fd_, &one, sizeof(one));
+}
+
+void EventLoop::Stop() {
+  stopping_ = true;
+  const uint64_t one = 1;
+  (void)write(wake_fd_, &one, sizeof(one));
+}
+
+absl::Status EventLoop::RunPosted() {
+  std::vector<Callback> posted;
+  {
+    absl::MutexLock lock(&mutex_);
+    posted.swap(posted_);
+  }
+  absl::Status status;
+  for (auto& callback : posted) status.Update(callback());
+  return status;
+}
+
+absl::Status EventLoop::Dispatch(int32_t fd) {
+  auto it = handlers_.find(fd);
+  // Removed by an earlier callback of the same batch.
+  if (it == handlers_.end()) return absl::OkStatus();
+  switch (it->second.kind) {
+    case Kind::kReader: {
+      Callback callback = it->second.callback;
+      return callback();
+    }
+    case Kind::kTimer: {
+      uint64_t expirations;
+      if (read(fd, &expirations, sizeof(expirations)) < 0) {
+        return errno == EAGAIN ? absl::OkStatus() : ErrnoError("read timerfd");
+      }
+      Callback callback = it->second.callback;
+      return callback();
+    }
+    case Kind::kWake: {
+      uint64_t count;
+      (void)read(fd, &count, sizeof(count));
+      return RunPosted();
+    }
+    case Kind::kSignal: {
+      signalfd_siginfo info;
+      if (read(fd, &info, sizeof(info)) == sizeof(info)) Stop();
+      return absl::OkStatus();
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status EventLoop::Run() {
+  absl::Status status;
+  epoll_event events[kMaxEvents];
+  while (!stopping_ && status.ok()) {
+    const int32_t count = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      status = ErrnoError("epoll_wait");
+      break;
+    }
+    for (int32_t i = 0; i < count && status.ok(); ++i) {
+      status = Dispatch(events[i].data.fd);
+    }
+  }
+
+  // Sources finish in-flight work and post it; deliver it before leaving.
+  for (auto& [id, hook] : shutdown_hooks_) hook();
+  status.Update(RunPosted());
+  stopping_ = false;
+  return status;
+}
+
+}  // namespace slam_dunk
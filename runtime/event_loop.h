@@ -0,0 +1,109 @@
+// Single-threaded event loop on epoll.
+#ifndef SLAM_DUNK_RUNTIME_EVENT_LOOP_H_
+#define SLAM_DUNK_RUNTIME_EVENT_LOOP_H_
+#include <signal.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace slam_dunk {
+
+// Blocks `signals` in the calling thread and in the threads it starts
+// afterwards, e.g. in main before libraries start threads, so that only an
+// EventLoop with StopOnSignals receives them.
+absl::Status BlockSignals(std::initializer_list<int> signals);
+
+// Dispatches readable file descriptors, periodic timers (timerfd), callbacks
+// posted from other threads (eventfd) and termination signals (signalfd).
+// The loop sleeps in epoll_wait between events instead of polling.
+//
+// All callbacks run on the thread calling Run(). A callback returning an
+// error stops the loop and Run() returns that error.
+class EventLoop {
+ public:
+  using Callback = std::function<absl::Status()>;
+
+  static absl::StatusOr<std::unique_ptr<EventLoop>> Create();
+  ~EventLoop();
+
+  // Calls `callback` whenever `fd` is readable. The callback must consume
+  // the data, the descriptor is level-triggered. `fd` is not owned.
+  absl::Status AddReader(int32_t fd, Callback callback);
+  absl::Status RemoveReader(int32_t fd);
+
+  // Calls `callback` every `period`, e.g. for metrics or heartbeats. Missed
+  // periods are coalesced into one call. Returns id for RemovePeriodic.
+  absl::StatusOr<int32_t> AddPeriodic(absl::Duration period,
+                                      Callback callback);
+  absl::Status RemovePeriodic(int32_t id);
+
+  // Stops the loop on any of `signals`. The signals are blocked in the
+  // calling thread until the loop is destroyed, which must happen on the
+  // same thread. Threads that already exist keep their mask and would take
+  // the signals with the default action, so block them with BlockSignals
+  // in main before any thread is started.
+  absl::Status StopOnSignals(std::initializer_list<int> signals);
+
+  // Registers hook that runs on the loop thread once the loop stops and
+  // before the remaining posted callbacks are drained. Sources use it to
+  // finish their in-flight work. Returns id for RemoveShutdownHook, which
+  // owners of the hook must call before they are destroyed. Neither is
+  // thread-safe, call them from the loop thread or while it is not running.
+  int32_t OnShutdown(std::function<void()> hook);
+  void RemoveShutdownHook(int32_t id);
+
+  // Queues callback to run on the loop thread. Thread-safe.
+  void Post(Callback callback);
+
+  // Makes Run() return after the current iteration. Thread-safe.
+  void Stop();
+
+  // Runs until Stop(), a signal or a failed callback. Then runs shutdown
+  // hooks and drains posted callbacks.
+  absl::Status Run();
+
+  // Not copyable
+  EventLoop(const EventLoop&) = delete;
+  EventLoop& operator=(const EventLoop&) = delete;
+
+ private:
+  enum class Kind { kReader, kTimer, kWake, kSignal };
+  struct Handler {
+    Kind kind;
+    Callback callback;
+  };
+
+  EventLoop(int32_t epoll_fd, int32_t wake_fd);
+  absl::Status Register(int32_t fd, Kind kind, Callback callback);
+  absl::Status Dispatch(int32_t fd);
+  // Runs callbacks queued with Post.
+  absl::Status RunPosted();
+
+  const int32_t epoll_fd_;
+  const int32_t wake_fd_;
+  int32_t signal_fd_ = -1;
+  // Mask of the thread that called StopOnSignals, restored on destruction.
+  sigset_t previous_mask_;
+  absl::flat_hash_map<int32_t, Handler> handlers_;
+  // Hooks in registration order, with their ids.
+  std::vector<std::pair<int32_t, std::function<void()>>> shutdown_hooks_;
+  int32_t next_hook_id_ = 0;
+  std::atomic<bool> stopping_ = false;
+
+  absl::Mutex mutex_;
+  std::vector<Callback> posted_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_RUNTIME_EVENT_LOOP_H_
@@ -0,0 +1,202 @@
+#include "runtime/event_loop.h"
+#include <signal.h>
+#include <unistd.h>
+#include <thread>
+#include "absl/status/status_matchers.h"
+#include "absl/time/clock.h"
+#include "gmock/gmock-matchers.h"
+#include "gtest/gtest.h"
+#include "runtime/scan_source.h"
+
+namespace slam_dunk {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::Ge;
+
+std::unique_ptr<EventLoop> MakeLoop() {
+  auto loop = EventLoop::Create();
+  EXPECT_THAT(loop, IsOk());
+  return *std::move(loop);
+}
+
+TEST(EventLoop, PeriodicTaskRunsUntilStopped) {
+  auto loop = MakeLoop();
+  int32_t calls = 0;
+  ASSERT_THAT(loop->AddPeriodic(absl::Milliseconds(1),
+                                [&] {
+                                  if (++calls == 5) loop->Stop();
+                                  return absl::OkStatus();
+                                }),
+              IsOk());
+  EXPECT_THAT(loop->Run(), IsOk());
+  EXPECT_EQ(calls, 5);
+}
+
+TEST(EventLoop, RemovePeriodic) {
+  auto loop = MakeLoop();
+  auto id = loop->AddPeriodic(absl::Milliseconds(1), [] {
+    return absl::OkStatus();
+  });
+  ASSERT_THAT(id, IsOk());
+  EXPECT_THAT(loop->RemovePeriodic(*id), IsOk());
+  EXPECT_THAT(loop->RemovePeriodic(*id),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(EventLoop, PostFromOtherThread) {
+  auto loop = MakeLoop();
+  std::vector<int32_t> values;
+  std::thread producer([&] {
+    for (int32_t i = 0; i < 3; ++i) {
+      loop->Post([&values, i] {
+        values.push_back(i);
+        return absl::OkStatus();
+      });
+    }
+    loop->Stop();
+  });
+  EXPECT_THAT(loop->Run(), IsOk());
+  producer.join();
+  EXPECT_THAT(values, ElementsAre(0, 1, 2));
+}
+
+TEST(EventLoop, ReaderIsCalledWhenReadable) {
+  auto loop = MakeLoop();
+  int pipe_fds[2];
+  ASSERT_EQ(pipe(pipe_fds), 0);
+  ASSERT_THAT(loop->AddReader(pipe_fds[0],
+                              [&] {
+                                char c;
+                                EXPECT_EQ(read(pipe_fds[0], &c, 1), 1);
+                                EXPECT_EQ(c, 'x');
+                                loop->Stop();
+                                return absl::OkStatus();
+                              }),
+              IsOk());
+  ASSERT_EQ(write(pipe_fds[1], "x", 1), 1);
+  EXPECT_THAT(loop->Run(), IsOk());
+  EXPECT_THAT(loop->RemoveReader(pipe_fds[0]), IsOk());
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+}
+
+TEST(EventLoop, FailedCallbackStopsLoop) {
+  auto loop = MakeLoop();
+  loop->Post([] { return absl::UnavailableError("visualizer is gone"); });
+  EXPECT_THAT(loop->Run(), StatusIs(absl::StatusCode::kUnavailable));
+}
+
+TEST(EventLoop, StopsOnSignal) {
+  auto loop = MakeLoop();
+  ASSERT_THAT(loop->StopOnSignals({SIGTERM}), IsOk());
+  bool hook_called = false;
+  loop->OnShutdown([&] { hook_called = true; });
+  // Blocked in this thread, so it stays pending for the signalfd.
+  ASSERT_EQ(raise(SIGTERM), 0);
+  EXPECT_THAT(loop->Run(), IsOk());
+  EXPECT_TRUE(hook_called);
+
+  // The mask is restored for the tests that follow.
+  loop.reset();
+  sigset_t mask;
+  ASSERT_EQ(pthread_sigmask(SIG_BLOCK, nullptr, &mask), 0);
+  EXPECT_FALSE(sigismember(&mask, SIGTERM));
+}
+
+TEST(BlockSignals, InheritedByLaterThreads) {
+  // In a thread of its own, to leave the mask of the test thread alone.
+  std::thread([] {
+    ASSERT_THAT(BlockSignals({SIGUSR1}), IsOk());
+    std::thread([] {
+      sigset_t mask;
+      ASSERT_EQ(pthread_sigmask(SIG_BLOCK, nullptr, &mask), 0);
+      EXPECT_TRUE(sigismember(&mask, SIGUSR1));
+    }).join();
+  }).join();
+}
+
+TEST(ScanSource, DrainsInFlightRevolutionOnShutdown) {
+  auto loop = MakeLoop();
+  std::atomic<int32_t> scanned = 0;
+  ScanSource source(*loop, [&]() -> absl::StatusOr<std::vector<ScanResponse>> {
+    absl::SleepFor(absl::Milliseconds(2));
+    ++scanned;
+    return std::vector<ScanResponse>(10);
+  });
+  int32_t delivered = 0;
+  source.AddSink([&](const std::vector<ScanResponse>& scan) {
+    EXPECT_EQ(scan.size(), 10);
+    if (++delivered == 3) loop->Stop();
+    return absl::OkStatus();
+  });
+  source.Start();
+  EXPECT_THAT(loop->Run(), IsOk());
+  // Every revolution that was scanned reached the sink or was replaced by
+  // a newer one.
+  EXPECT_EQ(delivered + source.dropped(), scanned);
+  EXPECT_EQ(source.revolutions(), delivered);
+  EXPECT_THAT(delivered, Ge(3));
+}
+
+TEST(ScanSource, CoalescesRevolutionsForSlowSink) {
+  auto loop = MakeLoop();
+  std::atomic<int32_t> scanned = 0;
+  ScanSource source(*loop, [&]() -> absl::StatusOr<std::vector<ScanResponse>> {
+    absl::SleepFor(absl::Milliseconds(1));
+    return std::vector<ScanResponse>(1, {.theta = static_cast<uint16_t>(
+                                            ++scanned)});
+  });
+  int32_t delivered = 0;
+  uint16_t last_theta = 0;
+  source.AddSink([&](const std::vector<ScanResponse>& scan) {
+    // Ten times slower than the lidar.
+    absl::SleepFor(absl::Milliseconds(10));
+    EXPECT_GT(scan[0].theta, last_theta);
+    last_theta = scan[0].theta;
+    if (++delivered == 5) loop->Stop();
+    return absl::OkStatus();
+  });
+  source.Start();
+  EXPECT_THAT(loop->Run(), IsOk());
+  EXPECT_GT(source.dropped(), 0);
+  EXPECT_EQ(source.revolutions() + source.dropped(), scanned);
+  // The drained revolution is the newest one scanned.
+  EXPECT_EQ(last_theta, scanned);
+}
+
+TEST(ScanSource, DestroyedBeforeLoop) {
+  auto loop = MakeLoop();
+  int32_t delivered = 0;
+  {
+    ScanSource source(*loop,
+                      [&]() -> absl::StatusOr<std::vector<ScanResponse>> {
+                        absl::SleepFor(absl::Milliseconds(1));
+                        return std::vector<ScanResponse>(1);
+                      });
+    source.AddSink([&](const std::vector<ScanResponse>&) {
+      ++delivered;
+      return absl::OkStatus();
+    });
+    source.Start();
+    absl::SleepFor(absl::Milliseconds(5));
+  }
+  // Neither the shutdown hook nor the queued revolution touch the source.
+  loop->Stop();
+  EXPECT_THAT(loop->Run(), IsOk());
+  EXPECT_EQ(delivered, 0);
+}
+
+TEST(ScanSource, ScannerErrorStopsLoop) {
+  auto loop = MakeLoop();
+  ScanSource source(*loop, []() -> absl::StatusOr<std::vector<ScanResponse>> {
+    return absl::InternalError("Failed to grabScanDataHq");
+  });
+  source.Start();
+  EXPECT_THAT(loop->Run(), StatusIs(absl::StatusCode::kInternal));
+}
+
+}  // namespace
+}  // namespace slam_dunk
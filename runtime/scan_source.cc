@@ -0,0 +1,88 @@
+#include "runtime/scan_source.h"
+#include <memory>
+
+namespace slam_dunk {
+
+ScanSource::ScanSource(EventLoop& loop, Scanner scanner)
+    : loop_(loop),
+      scanner_(std::move(scanner)),
+      channel_(std::make_shared<Channel>(loop)) {}
+
+ScanSource::~ScanSource() {
+  Stop();
+  if (shutdown_hook_ >= 0) loop_.RemoveShutdownHook(shutdown_hook_);
+  absl::MutexLock lock(&channel_->mutex);
+  channel_->closed = true;
+  channel_->pending.reset();
+}
+
+void ScanSource::AddSink(Sink sink) {
+  channel_->sinks.push_back(std::move(sink));
+}
+
+void ScanSource::Start() {
+  if (running_.exchange(true)) return;
+  thread_ = std::thread(&ScanSource::ScanLoop, this);
+  if (shutdown_hook_ < 0) {
+    shutdown_hook_ = loop_.OnShutdown([this] { Stop(); });
+  }
+}
+
+void ScanSource::Stop() {
+  running_ = false;
+  if (thread_.joinable()) thread_.join();
+}
+
+void ScanSource::ScanLoop() {
+  while (running_) {
+    auto scan = scanner_();
+    if (!scan.ok()) {
+      running_ = false;
+      loop_.Post([status = scan.status()] { return status; });
+      return;
+    }
+    Offer(*std::move(scan));
+  }
+}
+
+void ScanSource::Offer(std::vector<ScanResponse> revolution) {
+  // Shared so that the revolution is not copied into the callback.
+  auto shared =
+      std::make_shared<const std::vector<ScanResponse>>(std::move(revolution));
+  absl::MutexLock lock(&channel_->mutex);
+  if (channel_->pending != nullptr) ++channel_->dropped;
+  channel_->pending = std::move(shared);
+  if (channel_->in_flight) return;
+  channel_->in_flight = true;
+  loop_.Post([channel = channel_] { return Deliver(channel); });
+}
+
+absl::Status ScanSource::Deliver(const std::shared_ptr<Channel>& channel) {
+  std::shared_ptr<const std::vector<ScanResponse>> revolution;
+  {
+    absl::MutexLock lock(&channel->mutex);
+    if (channel->closed) return absl::OkStatus();
+    revolution = std::move(channel->pending);
+    channel->pending = nullptr;
+  }
+  if (revolution != nullptr) {
+    for (const auto& sink : channel->sinks) {
+      if (auto status = sink(*revolution); !status.ok()) {
+        // Stops the loop; the next revolution queues a new callback.
+        absl::MutexLock lock(&channel->mutex);
+        channel->in_flight = false;
+        return status;
+      }
+    }
+    ++channel->revolutions;
+  }
+  absl::MutexLock lock(&channel->mutex);
+  if (channel->pending == nullptr || channel->closed) {
+    channel->in_flight = false;
+  } else {
+    channel->loop.Post([channel] { return Deliver(channel); });
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace slam_dunk
@@ -0,0 +1,93 @@
+// Lidar revolutions delivered through the event loop.
+#ifndef SLAM_DUNK_RUNTIME_SCAN_SOURCE_H_
+#define SLAM_DUNK_RUNTIME_SCAN_SOURCE_H_
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "lidar.h"
+#include "runtime/event_loop.h"
+
+namespace slam_dunk {
+
+// Runs a blocking scanner such as Lidar::Scan on its own thread and hands
+// revolutions to the sinks on the event loop thread. One source per device;
+// many sources and sinks can share one loop.
+//
+// At most one revolution is queued on the loop. If the sinks are slower than
+// the lidar, revolutions scanned meanwhile are coalesced: only the newest is
+// kept and the others are counted as dropped, so memory stays bounded and
+// sinks see fresh data.
+class ScanSource {
+ public:
+  using Scanner =
+      std::function<absl::StatusOr<std::vector<ScanResponse>>()>;
+  using Sink = std::function<absl::Status(const std::vector<ScanResponse>&)>;
+
+  // The loop must outlive the source. Revolutions still queued when the
+  // source is destroyed are discarded.
+  ScanSource(EventLoop& loop, Scanner scanner);
+  ~ScanSource();
+
+  // Sinks are called in the order they were added. Add them before Start.
+  void AddSink(Sink sink);
+
+  // Starts the scanning thread and stops it when the loop shuts down.
+  void Start();
+
+  // Lets the in-flight revolution complete and be posted, then joins the
+  // scanning thread. Called automatically on loop shutdown.
+  void Stop();
+
+  // Number of revolutions delivered to the sinks.
+  int64_t revolutions() const { return channel_->revolutions; }
+
+  // Number of revolutions replaced by a newer one before delivery.
+  int64_t dropped() const { return channel_->dropped; }
+
+  // Not copyable
+  ScanSource(const ScanSource&) = delete;
+  ScanSource& operator=(const ScanSource&) = delete;
+
+ private:
+  // State shared with callbacks posted to the loop, which may run after the
+  // source is gone.
+  struct Channel {
+    EventLoop& loop;
+    std::vector<Sink> sinks;
+    absl::Mutex mutex;
+    // Newest revolution not yet taken by the loop.
+    std::shared_ptr<const std::vector<ScanResponse>> pending
+        ABSL_GUARDED_BY(mutex);
+    // A Deliver callback is queued or running.
+    bool in_flight ABSL_GUARDED_BY(mutex) = false;
+    // Set by the destructor; later callbacks do nothing.
+    bool closed ABSL_GUARDED_BY(mutex) = false;
+    std::atomic<int64_t> revolutions = 0;
+    std::atomic<int64_t> dropped = 0;
+  };
+
+  void ScanLoop();
+  // Hands pending revolution to the loop, coalescing with a queued one.
+  void Offer(std::vector<ScanResponse> revolution);
+  // Runs on the loop thread: delivers the pending revolution and queues
+  // itself again if another one arrived meanwhile.
+  static absl::Status Deliver(const std::shared_ptr<Channel>& channel);
+
+  EventLoop& loop_;
+  Scanner scanner_;
+  std::shared_ptr<Channel> channel_;
+  std::thread thread_;
+  std::atomic<bool> running_ = false;
+  int32_t shutdown_hook_ = -1;
+};
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_RUNTIME_SCAN_SOURCE_H_
@@ -0,0 +1,87 @@
+#include "scan_binary.h"
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+
+namespace slam_dunk {
+namespace {
+
+static_assert(std::endian::native == std::endian::little,
+              "Scan binary encoding assumes a little-endian host");
+
+}  // namespace
+
+std::string EncodeScanBinary(const std::vector<ScanResponse>& scan) {
+  std::string data(kScanBinaryHeaderSize + scan.size() * kScanBinaryRecordSize,
+                   '\0');
+  char* out = data.data();
+  std::memcpy(out, kScanBinaryMagic.data(), kScanBinaryMagic.size());
+  const uint64_t count = scan.size();
+  std::memcpy(out + 8, &count, sizeof(count));
+  out += kScanBinaryHeaderSize;
+  for (const ScanResponse& response : scan) {
+    std::memcpy(out, &response.theta, 2);
+    out[2] = static_cast<char>(response.quality);
+    out[3] = static_cast<char>(response.flag);
+    std::memcpy(out + 4, &response.distance_mm, 4);
+    out += kScanBinaryRecordSize;
+  }
+  return data;
+}
+
+absl::StatusOr<std::vector<ScanResponse>> DecodeScanBinary(
+    absl::string_view data) {
+  if (data.size() < kScanBinaryHeaderSize ||
+      data.substr(0, kScanBinaryMagic.size()) != kScanBinaryMagic) {
+    return absl::InvalidArgumentError("Not a binary scan");
+  }
+  uint64_t count = 0;
+  std::memcpy(&count, data.data() + 8, sizeof(count));
+  if ((data.size() - kScanBinaryHeaderSize) / kScanBinaryRecordSize != count ||
+      (data.size() - kScanBinaryHeaderSize) % kScanBinaryRecordSize != 0) {
+    return absl::DataLossError(absl::StrFormat(
+        "Binary scan of %d samples has %d bytes", count, data.size()));
+  }
+  std::vector<ScanResponse> scan(count);
+  const char* in = data.data() + kScanBinaryHeaderSize;
+  for (ScanResponse& response : scan) {
+    std::memcpy(&response.theta, in, 2);
+    response.quality = static_cast<uint8_t>(in[2]);
+    response.flag = static_cast<uint8_t>(in[3]);
+    std::memcpy(&response.distance_mm, in + 4, 4);
+    in += kScanBinaryRecordSize;
+  }
+  return scan;
+}
+
+absl::Status SaveBinaryToFile(const std::vector<ScanResponse>& scan,
+                              absl::string_view file_path) {
+  const std::string data = EncodeScanBinary(scan);
+  std::ofstream output(std::string{file_path}, std::ios::binary);
+  output.write(data.data(), static_cast<std::streamsize>(data.size()));
+  output.close();
+  if (!output) {
+    return absl::InternalError(absl::StrCat("Failed to write to ", file_path));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<ScanResponse>> LoadBinaryFromFile(
+    absl::string_view file_path) {
+  std::ifstream input(std::string{file_path},
+                      std::ios::binary | std::ios::ate);
+  if (!input) {
+    return absl::NotFoundError(absl::StrCat("Failed to open ", file_path));
+  }
+  std::string data(static_cast<size_t>(input.tellg()), '\0');
+  input.seekg(0);
+  input.read(data.data(), static_cast<std::streamsize>(data.size()));
+  if (!input) {
+    return absl::DataLossError(absl::StrCat("Failed to read ", file_path));
+  }
+  return DecodeScanBinary(data);
+}
+
+}  // namespace slam_dunk
@@ -0,0 +1,32 @@
+// Compact binary form of recorded scans.
+#ifndef SLAM_DUNK__SCAN_BINARY_H_
+#define SLAM_DUNK__SCAN_BINARY_H_
+#include <string>
+#include <vector>
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "lidar.h"
+
+namespace slam_dunk {
+
+// An 8 byte magic "SLDKSCN1", the number of samples as a little-endian
+// uint64, then 8 bytes per sample: theta (uint16), quality (uint8), flag
+// (uint8) and distance_mm (uint32), all little-endian. About a sixth of
+// the text proto written by SaveToFile, and read with a single copy.
+inline constexpr absl::string_view kScanBinaryMagic = "SLDKSCN1";
+inline constexpr size_t kScanBinaryHeaderSize = 16;
+inline constexpr size_t kScanBinaryRecordSize = 8;
+
+std::string EncodeScanBinary(const std::vector<ScanResponse>& scan);
+absl::StatusOr<std::vector<ScanResponse>> DecodeScanBinary(
+    absl::string_view data);
+
+absl::Status SaveBinaryToFile(const std::vector<ScanResponse>& scan,
+                              absl::string_view file_path);
+absl::StatusOr<std::vector<ScanResponse>> LoadBinaryFromFile(
+    absl::string_view file_path);
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK__SCAN_BINARY_H_
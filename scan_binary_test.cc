@@ -0,0 +1,54 @@
+#include "scan_binary.h"
+#include <string>
+#include <vector>
+#include "absl/status/status_matchers.h"
+#include "gtest/gtest.h"
+
+namespace slam_dunk {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::StatusIs;
+
+std::vector<ScanResponse> Scan() {
+  return {ScanResponse{.theta = 5566, .distance_mm = 2257, .quality = 60},
+          ScanResponse{.theta = 65535,
+                       .distance_mm = 4000000,
+                       .quality = 255,
+                       .flag = 1},
+          ScanResponse{}};
+}
+
+TEST(ScanBinary, RoundTrip) {
+  const std::string data = EncodeScanBinary(Scan());
+  EXPECT_EQ(data.size(), kScanBinaryHeaderSize + 3 * kScanBinaryRecordSize);
+  auto scan = DecodeScanBinary(data);
+  ASSERT_THAT(scan, IsOk());
+  ASSERT_EQ(scan->size(), 3);
+  EXPECT_EQ((*scan)[1].theta, 65535);
+  EXPECT_EQ((*scan)[1].distance_mm, 4000000);
+  EXPECT_EQ((*scan)[1].quality, 255);
+  EXPECT_EQ((*scan)[1].flag, 1);
+  EXPECT_EQ((*scan)[0].distance_mm, 2257);
+}
+
+TEST(ScanBinary, File) {
+  const std::string path = ::testing::TempDir() + "/scan.scanbin";
+  ASSERT_THAT(SaveBinaryToFile(Scan(), path), IsOk());
+  auto scan = LoadBinaryFromFile(path);
+  ASSERT_THAT(scan, IsOk());
+  EXPECT_EQ(scan->size(), 3);
+  EXPECT_THAT(LoadBinaryFromFile(path + ".missing"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(ScanBinary, RejectsBadData) {
+  EXPECT_THAT(DecodeScanBinary("items {"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  std::string data = EncodeScanBinary(Scan());
+  data.pop_back();
+  EXPECT_THAT(DecodeScanBinary(data), StatusIs(absl::StatusCode::kDataLoss));
+}
+
+}  // namespace
+}  // namespace slam_dunk
@@ -0,0 +1,54 @@
+// Conversions of raw lidar fixed-point values into metric geometry.
+#ifndef SLAM_DUNK__SCAN_GEOMETRY_H_
+#define SLAM_DUNK__SCAN_GEOMETRY_H_
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <Eigen/Core>
+#include "lidar.h"
+
+namespace slam_dunk {
+
+// Number of q14 angle units in a full revolution: 360 degrees is
+// 4 * 90 degrees, and 90 degrees is 1 << 14.
+inline constexpr uint32_t kThetaFullCircle = 1u << 16;
+
+// Converts q14 angle into radians.
+inline double ThetaToRadians(uint32_t theta) {
+  return theta * (2.0 * M_PI / kThetaFullCircle);
+}
+
+// Converts q2 millimeters into meters.
+inline double DistanceToMeters(uint32_t distance_mm) {
+  return distance_mm / 4000.0;
+}
+
+// Returns the point in the lidar frame. Angles grow clockwise on RPLidar,
+// so y is negated to get the usual counter-clockwise frame.
+inline Eigen::Vector2d ToCartesian(const ScanResponse& response) {
+  const double angle = ThetaToRadians(response.theta);
+  const double range = DistanceToMeters(response.distance_mm);
+  return {range * std::cos(angle), -range * std::sin(angle)};
+}
+
+// Returns true if the lidar reported an actual return for this sample.
+inline bool IsValid(const ScanResponse& response) {
+  return response.distance_mm != 0;
+}
+
+// Rigid 2D transform: rotation by theta followed by translation.
+struct Pose2d {
+  double x = 0;
+  double y = 0;
+  double theta = 0;
+
+  Eigen::Vector2d operator*(const Eigen::Vector2d& p) const {
+    const double c = std::cos(theta);
+    const double s = std::sin(theta);
+    return {c * p.x() - s * p.y() + x, s * p.x() + c * p.y() + y};
+  }
+};
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK__SCAN_GEOMETRY_H_
@@ -0,0 +1,66 @@
+// Memory layout shared by ShmPublisher and ShmReader.
+#ifndef SLAM_DUNK_SHM_SHM_LAYOUT_H_
+#define SLAM_DUNK_SHM_SHM_LAYOUT_H_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "lidar.h"
+
+namespace slam_dunk::shm {
+
+inline constexpr uint64_t kMagic = 0x534c414d44554e4bULL;  // "SLAMDUNK"
+inline constexpr uint32_t kVersion = 2;
+
+// Start of the segment.
+struct Header {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t num_slots;
+  // Maximum number of samples in one slot.
+  uint32_t slot_capacity;
+  uint32_t slot_size;
+  // Random stamp chosen when the segment is created. A restarted publisher
+  // creates a new segment under the same name, readers compare stamps to
+  // notice that their mapping is stale.
+  uint64_t generation;
+  // Number of the latest complete revolution, starting at 1; 0 when
+  // nothing has been published yet. Revolution r lives in slot
+  // r % num_slots.
+  alignas(64) std::atomic<uint64_t> latest;
+};
+
+// Start of every slot, followed by `slot_capacity` samples.
+struct SlotHeader {
+  // Sequence counter of the seqlock: odd while the publisher writes.
+  alignas(64) std::atomic<uint64_t> sequence;
+  uint64_t revolution;
+  // steady_clock, i.e. CLOCK_MONOTONIC, so comparable across processes.
+  int64_t publish_time_ns;
+  uint32_t count;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Atomics in shared memory must be lock free");
+
+inline ScanResponse* SamplesOf(SlotHeader* slot) {
+  return reinterpret_cast<ScanResponse*>(reinterpret_cast<char*>(slot) +
+                                         sizeof(SlotHeader));
+}
+
+inline const ScanResponse* SamplesOf(const SlotHeader* slot) {
+  return reinterpret_cast<const ScanResponse*>(
+      reinterpret_cast<const char*>(slot) + sizeof(SlotHeader));
+}
+
+inline size_t SlotSize(uint32_t slot_capacity) {
+  const size_t size = sizeof(SlotHeader) + slot_capacity * sizeof(ScanResponse);
+  return (size + 63) / 64 * 64;
+}
+
+inline size_t SegmentSize(uint32_t num_slots, uint32_t slot_capacity) {
+  return sizeof(Header) + num_slots * SlotSize(slot_capacity);
+}
+
+}  // namespace slam_dunk::shm
+
+#endif  // SLAM_DUNK_SHM_SHM_LAYOUT_H_
@@ -0,0 +1,105 @@
+#include "shm/shm_publisher.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <utility>
+#include "absl/memory/memory.h"
+#include "absl/strings/str_format.h"
+
+namespace slam_dunk {
+
+absl::StatusOr<std::unique_ptr<ShmPublisher>> ShmPublisher::Create(
+    absl::string_view name, uint32_t num_slots, uint32_t slot_capacity) {
+  if (num_slots < 2 || slot_capacity == 0) {
+    return absl::InvalidArgumentError(
+        "Need at least two slots and non-zero capacity");
+  }
+  const std::string shm_name(name);
+  // Start from scratch so that stale readers' layout is not reused.
+  shm_unlink(shm_name.c_str());
+  const int fd = shm_open(shm_name.c_str(), O_CREAT | O_RDWR | O_EXCL, 0644);
+  if (fd < 0) {
+    return absl::InternalError(
+        absl::StrFormat("shm_open %s failed: %s", shm_name, strerror(errno)));
+  }
+  const size_t size = shm::SegmentSize(num_slots, slot_capacity);
+  if (ftruncate(fd, static_cast<off_t>(size)) < 0) {
+    close(fd);
+    shm_unlink(shm_name.c_str());
+    return absl::InternalError(
+        absl::StrFormat("ftruncate failed: %s", strerror(errno)));
+  }
+  void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    shm_unlink(shm_name.c_str());
+    return absl::InternalError(
+        absl::StrFormat("mmap failed: %s", strerror(errno)));
+  }
+
+  // ftruncate zero fills, so all sequences and `latest` start at zero.
+  auto* header = static_cast<shm::Header*>(memory);
+  header->version = shm::kVersion;
+  header->num_slots = num_slots;
+  header->slot_capacity = slot_capacity;
+  header->slot_size = static_cast<uint32_t>(shm::SlotSize(slot_capacity));
+  std::random_device random;
+  do {
+    header->generation = (uint64_t{random()} << 32) | random();
+  } while (header->generation == 0);
+  // Magic last, readers check it before trusting the rest.
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = shm::kMagic;
+  return absl::WrapUnique(new ShmPublisher(shm_name, memory, size));
+}
+
+ShmPublisher::ShmPublisher(std::string name, void* memory, size_t size)
+    : name_(std::move(name)),
+      memory_(memory),
+      size_(size),
+      header_(static_cast<shm::Header*>(memory)) {}
+
+ShmPublisher::~ShmPublisher() {
+  munmap(memory_, size_);
+  shm_unlink(name_.c_str());
+}
+
+shm::SlotHeader* ShmPublisher::Slot(uint64_t revolution) {
+  auto* base = static_cast<char*>(memory_) + sizeof(shm::Header);
+  return reinterpret_cast<shm::SlotHeader*>(
+      base + (revolution % header_->num_slots) * header_->slot_size);
+}
+
+absl::Status ShmPublisher::Publish(const std::vector<ScanResponse>& scan) {
+  if (scan.size() > header_->slot_capacity) {
+    return absl::OutOfRangeError(
+        absl::StrFormat("Revolution of %d samples exceeds slot capacity %d",
+                        scan.size(), header_->slot_capacity));
+  }
+  const uint64_t revolution = revolution_ + 1;
+  shm::SlotHeader* slot = Slot(revolution);
+
+  // Seqlock write: odd sequence, payload, even sequence.
+  const uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+  slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot->revolution = revolution;
+  slot->publish_time_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+  slot->count = static_cast<uint32_t>(scan.size());
+  std::memcpy(shm::SamplesOf(slot), scan.data(),
+              scan.size() * sizeof(ScanResponse));
+  slot->sequence.store(sequence + 2, std::memory_order_release);
+
+  header_->latest.store(revolution, std::memory_order_release);
+  revolution_ = revolution;
+  return absl::OkStatus();
+}
+
+}  // namespace slam_dunk
@@ -0,0 +1,55 @@
+// Publishes lidar revolutions into POSIX shared memory.
+#ifndef SLAM_DUNK_SHM_SHM_PUBLISHER_H_
+#define SLAM_DUNK_SHM_SHM_PUBLISHER_H_
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "lidar.h"
+#include "shm/shm_layout.h"
+
+namespace slam_dunk {
+
+// Single writer of a ring of fixed-size revolution slots in a POSIX shared
+// memory segment. Each slot is guarded by a sequence counter, so readers on
+// the same host map the segment and read the latest revolution in place,
+// without copies or syscalls, while the publisher never waits for them.
+class ShmPublisher {
+ public:
+  // Creates or replaces segment `name`, e.g. "/slam_dunk_lidar". Readers
+  // may hold a revolution for num_slots - 1 publications before it is
+  // overwritten.
+  static absl::StatusOr<std::unique_ptr<ShmPublisher>> Create(
+      absl::string_view name, uint32_t num_slots = 8,
+      uint32_t slot_capacity = 16384);
+  // Unmaps and removes the segment.
+  ~ShmPublisher();
+
+  // Copies revolution into the next slot and makes it the latest.
+  absl::Status Publish(const std::vector<ScanResponse>& scan);
+
+  // Number of the last published revolution.
+  uint64_t revolution() const { return revolution_; }
+
+  // Not copyable
+  ShmPublisher(const ShmPublisher&) = delete;
+  ShmPublisher& operator=(const ShmPublisher&) = delete;
+
+ private:
+  ShmPublisher(std::string name, void* memory, size_t size);
+  shm::SlotHeader* Slot(uint64_t revolution);
+
+  std::string name_;
+  void* memory_;
+  size_t size_;
+  shm::Header* header_;
+  uint64_t revolution_ = 0;
+};
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_SHM_SHM_PUBLISHER_H_
@@ -0,0 +1,135 @@
+#include "shm/shm_reader.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <utility>
+#include "absl/memory/memory.h"
+#include "absl/strings/str_format.h"
+
+namespace slam_dunk {
+
+absl::StatusOr<std::unique_ptr<ShmReader>> ShmReader::Open(
+    absl::string_view name) {
+  std::string shm_name(name);
+  auto mapping = Map(shm_name);
+  if (!mapping.ok()) return mapping.status();
+  return absl::WrapUnique(new ShmReader(std::move(shm_name), *mapping));
+}
+
+absl::StatusOr<ShmReader::Mapping> ShmReader::Map(const std::string& name) {
+  const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      return absl::NotFoundError(
+          absl::StrFormat("No shared memory segment %s", name));
+    }
+    return absl::InternalError(
+        absl::StrFormat("shm_open %s failed: %s", name, strerror(errno)));
+  }
+  struct stat info;
+  if (fstat(fd, &info) < 0) {
+    close(fd);
+    return absl::InternalError(
+        absl::StrFormat("fstat failed: %s", strerror(errno)));
+  }
+  const size_t size = static_cast<size_t>(info.st_size);
+  if (size < sizeof(shm::Header)) {
+    close(fd);
+    return absl::UnavailableError("Segment is not initialized yet");
+  }
+  void* memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    return absl::InternalError(
+        absl::StrFormat("mmap failed: %s", strerror(errno)));
+  }
+
+  const auto* header = static_cast<const shm::Header*>(memory);
+  absl::Status status;
+  if (header->magic != shm::kMagic) {
+    status = absl::UnavailableError("Segment is not initialized yet");
+  } else if (header->version != shm::kVersion) {
+    status = absl::FailedPreconditionError(absl::StrFormat(
+        "Segment version %d, expected %d", header->version, shm::kVersion));
+  } else if (size < shm::SegmentSize(header->num_slots,
+                                     header->slot_capacity)) {
+    status = absl::DataLossError("Segment is truncated");
+  }
+  if (!status.ok()) {
+    munmap(memory, size);
+    return status;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return Mapping{memory, size};
+}
+
+ShmReader::ShmReader(std::string name, Mapping mapping)
+    : name_(std::move(name)),
+      memory_(mapping.memory),
+      size_(mapping.size),
+      header_(static_cast<const shm::Header*>(mapping.memory)) {}
+
+ShmReader::~ShmReader() { munmap(const_cast<void*>(memory_), size_); }
+
+absl::StatusOr<bool> ShmReader::Refresh() {
+  auto mapping = Map(name_);
+  if (!mapping.ok()) return mapping.status();
+  const auto* header = static_cast<const shm::Header*>(mapping->memory);
+  if (header->generation == header_->generation) {
+    munmap(const_cast<void*>(mapping->memory), mapping->size);
+    return false;
+  }
+  munmap(const_cast<void*>(memory_), size_);
+  memory_ = mapping->memory;
+  size_ = mapping->size;
+  header_ = header;
+  return true;
+}
+
+const shm::SlotHeader* ShmReader::Slot(uint64_t revolution) const {
+  const auto* base = static_cast<const char*>(memory_) + sizeof(shm::Header);
+  return reinterpret_cast<const shm::SlotHeader*>(
+      base + (revolution % header_->num_slots) * header_->slot_size);
+}
+
+std::optional<ShmRevolution> ShmReader::TryReadLatest(uint64_t after) const {
+  while (true) {
+    const uint64_t revolution = latest();
+    if (revolution <= after) return std::nullopt;
+    const shm::SlotHeader* slot = Slot(revolution);
+    const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+    // Odd: the publisher is already rewriting this slot, reload latest.
+    if (sequence & 1) continue;
+    ShmRevolution view;
+    view.revolution = slot->revolution;
+    view.publish_time_ns = slot->publish_time_ns;
+    const uint32_t count = std::min(slot->count, header_->slot_capacity);
+    view.samples = absl::MakeConstSpan(shm::SamplesOf(slot), count);
+    view.sequence = sequence;
+    // The header fields above are only consistent if the slot is unchanged.
+    if (view.revolution == revolution && Validate(view)) return view;
+  }
+}
+
+bool ShmReader::Validate(const ShmRevolution& view) const {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return Slot(view.revolution)->sequence.load(std::memory_order_relaxed) ==
+         view.sequence;
+}
+
+uint64_t ShmReader::CopyLatest(std::vector<ScanResponse>& out,
+                               uint64_t after) const {
+  while (true) {
+    std::optional<ShmRevolution> view = TryReadLatest(after);
+    if (!view.has_value()) return 0;
+    out.assign(view->samples.begin(), view->samples.end());
+    if (Validate(*view)) return view->revolution;
+  }
+}
+
+}  // namespace slam_dunk
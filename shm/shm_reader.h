@@ -0,0 +1,90 @@
+// Reads lidar revolutions published by ShmPublisher.
+#ifndef SLAM_DUNK_SHM_SHM_READER_H_
+#define SLAM_DUNK_SHM_SHM_READER_H_
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "lidar.h"
+#include "shm/shm_layout.h"
+
+namespace slam_dunk {
+
+// A revolution read in place from the shared memory ring. The samples stay
+// valid until the publisher laps the ring; call ShmReader::Validate after
+// using them to confirm they were not overwritten meanwhile.
+struct ShmRevolution {
+  uint64_t revolution = 0;
+  int64_t publish_time_ns = 0;
+  absl::Span<const ScanResponse> samples;
+
+  // Sequence of the slot when the view was taken.
+  uint64_t sequence = 0;
+};
+
+// Maps a segment created by ShmPublisher read-only. Any number of readers,
+// in any number of processes, may read the same segment concurrently; they
+// never block the publisher nor each other.
+class ShmReader {
+ public:
+  static absl::StatusOr<std::unique_ptr<ShmReader>> Open(
+      absl::string_view name);
+  ~ShmReader();
+
+  // Checks whether the publisher recreated the segment, e.g. after a
+  // restart, and maps the new one if so. Returns true when remapped:
+  // revolution numbers start over and views taken before are invalid.
+  // Does a few syscalls, so call it when no revolution arrived for a while
+  // rather than on every poll. NotFound while no publisher is running.
+  absl::StatusOr<bool> Refresh();
+
+  // Stamp of the mapped segment, see shm::Header::generation.
+  uint64_t generation() const { return header_->generation; }
+
+  // Number of the latest published revolution, 0 if none.
+  uint64_t latest() const {
+    return header_->latest.load(std::memory_order_acquire);
+  }
+
+  // Returns a zero-copy view of the latest revolution if it is newer than
+  // `after`, nullopt otherwise.
+  std::optional<ShmRevolution> TryReadLatest(uint64_t after = 0) const;
+
+  // True while `view` has not been overwritten by the publisher.
+  bool Validate(const ShmRevolution& view) const;
+
+  // Copies the latest revolution newer than `after` into `out`, retrying
+  // when the publisher overwrote it during the copy. Returns its number, or
+  // 0 if there is nothing new.
+  uint64_t CopyLatest(std::vector<ScanResponse>& out, uint64_t after = 0) const;
+
+  // Not copyable
+  ShmReader(const ShmReader&) = delete;
+  ShmReader& operator=(const ShmReader&) = delete;
+
+ private:
+  struct Mapping {
+    const void* memory;
+    size_t size;
+  };
+
+  // Maps and validates the segment currently named `name`.
+  static absl::StatusOr<Mapping> Map(const std::string& name);
+
+  ShmReader(std::string name, Mapping mapping);
+  const shm::SlotHeader* Slot(uint64_t revolution) const;
+
+  std::string name_;
+  const void* memory_;
+  size_t size_;
+  const shm::Header* header_;
+};
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK_SHM_SHM_READER_H_
@@ -0,0 +1,141 @@
+// Publishes revolutions at a high rate while several reader processes
+// consume them, checking every sample read in place and reporting the
+// publish-to-read latency.
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "absl/status/status_matchers.h"
+#include "absl/strings/str_format.h"
+#include "gtest/gtest.h"
+#include "shm/shm_publisher.h"
+#include "shm/shm_reader.h"
+
+namespace slam_dunk {
+namespace {
+
+using ::absl_testing::IsOk;
+
+constexpr int kNumReaders = 4;
+constexpr int kNumRevolutions = 2000;
+constexpr int kSamplesPerRevolution = 8192;
+constexpr auto kPublishPeriod = std::chrono::microseconds(200);
+
+// What every reader process sends back to the test through a pipe.
+struct ReaderReport {
+  int32_t revolutions_read = 0;
+  int32_t corrupt = 0;
+  int32_t overwritten = 0;
+  int64_t latency_p50_ns = 0;
+  int64_t latency_p99_ns = 0;
+  int64_t latency_max_ns = 0;
+};
+
+int64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+ReaderReport RunReader(const std::string& name) {
+  ReaderReport report;
+  auto reader = ShmReader::Open(name);
+  if (!reader.ok()) {
+    report.corrupt = -1;
+    return report;
+  }
+  std::vector<int64_t> latencies;
+  latencies.reserve(kNumRevolutions);
+  uint64_t last = 0;
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  while (last < kNumRevolutions &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::optional<ShmRevolution> view = (*reader)->TryReadLatest(last);
+    if (!view.has_value()) continue;
+    latencies.push_back(NowNanos() - view->publish_time_ns);
+    bool consistent = view->samples.size() == kSamplesPerRevolution;
+    for (size_t i = 0; consistent && i < view->samples.size(); ++i) {
+      consistent = view->samples[i].theta == static_cast<uint16_t>(i) &&
+                   view->samples[i].distance_mm == view->revolution;
+    }
+    // Samples torn by a concurrent write are fine as long as Validate says
+    // so; a failed check on a valid view is real corruption.
+    if (!(*reader)->Validate(*view)) {
+      ++report.overwritten;
+    } else if (!consistent) {
+      ++report.corrupt;
+    }
+    ++report.revolutions_read;
+    last = view->revolution;
+  }
+  if (!latencies.empty()) {
+    std::sort(latencies.begin(), latencies.end());
+    report.latency_p50_ns = latencies[latencies.size() / 2];
+    report.latency_p99_ns = latencies[latencies.size() * 99 / 100];
+    report.latency_max_ns = latencies.back();
+  }
+  return report;
+}
+
+TEST(ShmStressTest, ReaderProcessesSeeConsistentRevolutions) {
+  const std::string name =
+      absl::StrFormat("/slam_dunk_shm_stress_%d", getpid());
+  auto publisher = ShmPublisher::Create(name, 8, kSamplesPerRevolution);
+  ASSERT_THAT(publisher, IsOk());
+
+  std::vector<pid_t> children;
+  std::vector<int> pipes;
+  for (int i = 0; i < kNumReaders; ++i) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    const pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+      close(fds[0]);
+      const ReaderReport report = RunReader(name);
+      const ssize_t written = write(fds[1], &report, sizeof(report));
+      _exit(written == sizeof(report) ? 0 : 1);
+    }
+    close(fds[1]);
+    children.push_back(pid);
+    pipes.push_back(fds[0]);
+  }
+
+  std::vector<ScanResponse> scan(kSamplesPerRevolution);
+  for (int i = 0; i < kSamplesPerRevolution; ++i) scan[i].theta = i;
+  auto next = std::chrono::steady_clock::now();
+  for (uint32_t revolution = 1; revolution <= kNumRevolutions; ++revolution) {
+    for (ScanResponse& sample : scan) sample.distance_mm = revolution;
+    ASSERT_THAT((*publisher)->Publish(scan), IsOk());
+    next += kPublishPeriod;
+    std::this_thread::sleep_until(next);
+  }
+
+  for (int i = 0; i < kNumReaders; ++i) {
+    ReaderReport report;
+    ASSERT_EQ(read(pipes[i], &report, sizeof(report)), sizeof(report));
+    close(pipes[i]);
+    int status = 0;
+    ASSERT_EQ(waitpid(children[i], &status, 0), children[i]);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // Shows up in the XML report with --gtest_output, not on every run.
+    const std::string reader = absl::StrFormat("reader_%d_", i);
+    RecordProperty(reader + "revolutions", report.revolutions_read);
+    RecordProperty(reader + "overwritten", report.overwritten);
+    RecordProperty(reader + "latency_p50_ns", report.latency_p50_ns);
+    RecordProperty(reader + "latency_p99_ns", report.latency_p99_ns);
+    RecordProperty(reader + "latency_max_ns", report.latency_max_ns);
+    EXPECT_EQ(report.corrupt, 0);
+    EXPECT_GT(report.revolutions_read, 0);
+  }
+}
+
+}  // namespace
+}  // namespace slam_dunk
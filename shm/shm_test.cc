@@ -0,0 +1,118 @@
+#include <unistd.h>
+#include <optional>
+#include <string>
+#include <vector>
+#include "absl/status/status_matchers.h"
+#include "absl/strings/str_format.h"
+#include "gtest/gtest.h"
+#include "shm/shm_publisher.h"
+#include "shm/shm_reader.h"
+
+namespace slam_dunk {
+namespace {
+
+using ::absl_testing::IsOk;
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+
+std::string SegmentName() {
+  return absl::StrFormat("/slam_dunk_shm_test_%d", getpid());
+}
+
+std::vector<ScanResponse> MakeRevolution(uint32_t revolution, int count) {
+  std::vector<ScanResponse> scan(count);
+  for (int i = 0; i < count; ++i) {
+    scan[i].theta = i;
+    scan[i].distance_mm = revolution;
+    scan[i].quality = 188;
+  }
+  return scan;
+}
+
+TEST(ShmTest, ReaderSeesLatestRevolution) {
+  auto publisher = ShmPublisher::Create(SegmentName(), 4, 1024);
+  ASSERT_THAT(publisher, IsOk());
+  auto reader = ShmReader::Open(SegmentName());
+  ASSERT_THAT(reader, IsOk());
+  EXPECT_FALSE((*reader)->TryReadLatest().has_value());
+
+  ASSERT_THAT((*publisher)->Publish(MakeRevolution(1, 100)), IsOk());
+  ASSERT_THAT((*publisher)->Publish(MakeRevolution(2, 200)), IsOk());
+  std::optional<ShmRevolution> view = (*reader)->TryReadLatest();
+  ASSERT_TRUE(view.has_value());
+  EXPECT_EQ(view->revolution, 2);
+  ASSERT_EQ(view->samples.size(), 200);
+  EXPECT_EQ(view->samples[199].theta, 199);
+  EXPECT_EQ(view->samples[199].distance_mm, 2);
+  EXPECT_TRUE((*reader)->Validate(*view));
+  EXPECT_FALSE((*reader)->TryReadLatest(2).has_value());
+}
+
+TEST(ShmTest, LappedViewIsInvalid) {
+  auto publisher = ShmPublisher::Create(SegmentName(), 2, 16);
+  ASSERT_THAT(publisher, IsOk());
+  auto reader = ShmReader::Open(SegmentName());
+  ASSERT_THAT(reader, IsOk());
+
+  ASSERT_THAT((*publisher)->Publish(MakeRevolution(1, 8)), IsOk());
+  std::optional<ShmRevolution> view = (*reader)->TryReadLatest();
+  ASSERT_TRUE(view.has_value());
+  ASSERT_THAT((*publisher)->Publish(MakeRevolution(2, 8)), IsOk());
+  EXPECT_TRUE((*reader)->Validate(*view));
+  ASSERT_THAT((*publisher)->Publish(MakeRevolution(3, 8)), IsOk());
+  EXPECT_FALSE((*reader)->Validate(*view));
+
+  std::vector<ScanResponse> copy;
+  EXPECT_EQ((*reader)->CopyLatest(copy), 3);
+  ASSERT_EQ(copy.size(), 8);
+  EXPECT_EQ(copy[0].distance_mm, 3);
+}
+
+TEST(ShmTest, RejectsOversizedRevolution) {
+  auto publisher = ShmPublisher::Create(SegmentName(), 2, 16);
+  ASSERT_THAT(publisher, IsOk());
+  EXPECT_THAT((*publisher)->Publish(MakeRevolution(1, 17)),
+              StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+TEST(ShmTest, MissingSegment) {
+  EXPECT_THAT(ShmReader::Open("/slam_dunk_shm_test_missing"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(ShmTest, SegmentRemovedWithPublisher) {
+  { ASSERT_THAT(ShmPublisher::Create(SegmentName()), IsOk()); }
+  EXPECT_THAT(ShmReader::Open(SegmentName()),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(ShmTest, RefreshFollowsRestartedPublisher) {
+  auto first = ShmPublisher::Create(SegmentName(), 4, 16);
+  ASSERT_THAT(first, IsOk());
+  ASSERT_THAT((*first)->Publish(MakeRevolution(1, 8)), IsOk());
+  ASSERT_THAT((*first)->Publish(MakeRevolution(2, 8)), IsOk());
+  auto reader = ShmReader::Open(SegmentName());
+  ASSERT_THAT(reader, IsOk());
+  EXPECT_THAT((*reader)->Refresh(), IsOkAndHolds(false));
+  const uint64_t generation = (*reader)->generation();
+
+  first->reset();
+  EXPECT_THAT((*reader)->Refresh(), StatusIs(absl::StatusCode::kNotFound));
+  // The old mapping stays readable until remapped.
+  EXPECT_EQ((*reader)->latest(), 2);
+
+  auto second = ShmPublisher::Create(SegmentName(), 4, 16);
+  ASSERT_THAT(second, IsOk());
+  ASSERT_THAT((*second)->Publish(MakeRevolution(7, 8)), IsOk());
+  EXPECT_EQ((*reader)->latest(), 2);
+  EXPECT_THAT((*reader)->Refresh(), IsOkAndHolds(true));
+  EXPECT_NE((*reader)->generation(), generation);
+  std::vector<ScanResponse> copy;
+  EXPECT_EQ((*reader)->CopyLatest(copy), 1);
+  ASSERT_EQ(copy.size(), 8);
+  EXPECT_EQ(copy[0].distance_mm, 7);
+  EXPECT_THAT((*reader)->Refresh(), IsOkAndHolds(false));
+}
+
+}  // namespace
+}  // namespace slam_dunk
@@ -0,0 +1,83 @@
+#include "simulated_scan.h"
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace slam_dunk {
+namespace {
+
+// Returns distance along the ray to the wall or infinity.
+double IntersectWall(const Eigen::Vector2d& origin, const Eigen::Vector2d& dir,
+                     const SimulatedWall& wall) {
+  const Eigen::Vector2d edge = wall.end - wall.start;
+  const double denom = dir.x() * edge.y() - dir.y() * edge.x();
+  if (std::abs(denom) < 1e-12) return std::numeric_limits<double>::infinity();
+  const Eigen::Vector2d diff = wall.start - origin;
+  const double t = (diff.x() * edge.y() - diff.y() * edge.x()) / denom;
+  const double u = (diff.x() * dir.y() - diff.y() * dir.x()) / denom;
+  if (t < 0 || u < 0 || u > 1) return std::numeric_limits<double>::infinity();
+  return t;
+}
+
+// Returns distance along the ray to the circle or infinity.
+double IntersectCircle(const Eigen::Vector2d& origin,
+                       const Eigen::Vector2d& dir,
+                       const SimulatedCircle& circle) {
+  const Eigen::Vector2d diff = origin - circle.center;
+  const double b = diff.dot(dir);
+  const double c = diff.squaredNorm() - circle.radius * circle.radius;
+  const double discriminant = b * b - c;
+  if (discriminant < 0) return std::numeric_limits<double>::infinity();
+  const double t = -b - std::sqrt(discriminant);
+  return t >= 0 ? t : std::numeric_limits<double>::infinity();
+}
+
+}  // namespace
+
+SimulatedWorld SimulatedWorld::Room(double width, double height) {
+  SimulatedWorld world;
+  const Eigen::Vector2d a(0, 0), b(width, 0), c(width, height), d(0, height);
+  world.walls = {{a, b}, {b, c}, {c, d}, {d, a}};
+  return world;
+}
+
+std::vector<ScanResponse> SimulateScan(const SimulatedWorld& world,
+                                       const Pose2d& pose, size_t count,
+                                       double range_sigma_m, uint32_t seed,
+                                       double max_range_m) {
+  std::mt19937 generator(seed);
+  std::normal_distribution<double> noise(0.0, range_sigma_m);
+  const Eigen::Vector2d origin(pose.x, pose.y);
+
+  std::vector<ScanResponse> scan;
+  scan.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    const auto theta =
+        static_cast<uint16_t>(i * uint64_t{kThetaFullCircle} / count);
+    // Lidar angles are clockwise, see ToCartesian.
+    const double angle = pose.theta - ThetaToRadians(theta);
+    const Eigen::Vector2d dir(std::cos(angle), std::sin(angle));
+
+    double range = std::numeric_limits<double>::infinity();
+    for (const auto& wall : world.walls) {
+      range = std::min(range, IntersectWall(origin, dir, wall));
+    }
+    for (const auto& circle : world.circles) {
+      range = std::min(range, IntersectCircle(origin, dir, circle));
+    }
+    if (range_sigma_m > 0) range += noise(generator);
+
+    uint32_t distance_mm = 0;
+    if (range > 0 && range <= max_range_m) {
+      distance_mm = static_cast<uint32_t>(std::lround(range * 4000.0));
+    }
+    scan.push_back(
+        ScanResponse{.theta = theta,
+                     .distance_mm = distance_mm,
+                     .quality = static_cast<uint8_t>(distance_mm ? 188 : 0),
+                     .flag = static_cast<uint8_t>(i == 0)});
+  }
+  return scan;
+}
+
+}  // namespace slam_dunk
@@ -0,0 +1,46 @@
+// Synthetic lidar revolutions for tests and benchmarks.
+#ifndef SLAM_DUNK__SIMULATED_SCAN_H_
+#define SLAM_DUNK__SIMULATED_SCAN_H_
+#include <cstdint>
+#include <vector>
+#include <Eigen/Core>
+#include "lidar.h"
+#include "scan_geometry.h"
+
+namespace slam_dunk {
+
+// Straight wall between two points, in meters.
+struct SimulatedWall {
+  Eigen::Vector2d start;
+  Eigen::Vector2d end;
+};
+
+// Round object such as a leg, a post or a person.
+struct SimulatedCircle {
+  Eigen::Vector2d center;
+  double radius;
+};
+
+// Static description of what the lidar can see.
+struct SimulatedWorld {
+  std::vector<SimulatedWall> walls;
+  std::vector<SimulatedCircle> circles;
+
+  // Returns axis-aligned rectangular room with the lower-left corner in
+  // origin.
+  static SimulatedWorld Room(double width, double height);
+};
+
+// Ray casts one revolution of `count` samples from the lidar at `pose`.
+// Samples are ordered by theta, as Lidar::Scan returns them. Gaussian noise
+// with `range_sigma_m` is added to each range; rays that hit nothing or
+// go beyond `max_range_m` are reported with zero distance.
+std::vector<ScanResponse> SimulateScan(const SimulatedWorld& world,
+                                       const Pose2d& pose, size_t count,
+                                       double range_sigma_m = 0.0,
+                                       uint32_t seed = 1,
+                                       double max_range_m = 12.0);
+
+}  // namespace slam_dunk
+
+#endif  // SLAM_DUNK__SIMULATED_SCAN_H_